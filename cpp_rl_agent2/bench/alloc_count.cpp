@@ -0,0 +1,22 @@
+// Global operator new/delete replacements for json_bench, counting every heap allocation in the
+// process so run() can report allocations per op. They live in their own translation unit so the
+// compiler never inlines free() into a call site it sees paired with operator new, which would
+// set off -Wmismatched-new-delete at every new/delete in the benchmarks.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+std::atomic<std::size_t> allocations{ 0 };
+
+void *operator new(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
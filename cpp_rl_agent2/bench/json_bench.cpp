@@ -0,0 +1,424 @@
+#include "jdevtools/jdevarena.hpp"
+#include "jdevtools/jdevflatmap.hpp"
+#include "jdevtools/jdevintern.hpp"
+#include "jdevtools/jdevjournal.hpp"
+#include "jdevtools/jdevjsonpath.hpp"
+#include "jdevtools/jdevjsonview.hpp"
+#include "jdevtools/jdevjsonwriter.hpp"
+#include "jdevtools/jdevmmap.hpp"
+#include "jdevtools/jdevparallel.hpp"
+#include "jdevtools/jdevtypedarray.hpp"
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+using namespace jdevtools;
+using namespace std;
+
+static constexpr int A = 4;
+static constexpr int GRID_SIZE = 40;
+
+// Heap allocations so far; counted by the operator new replacement in alloc_count.cpp.
+extern atomic<size_t> allocations;
+
+// Fixtures are generated from fixed seeds, so every run (and every machine) times the same bytes;
+// "json_bench --fixtures <dir>" writes them out for use elsewhere.
+
+// Same shape as a gw.php "move" response.
+static string makeMoveResponse() {
+	json js;
+	js["code"] = "OK";
+	js["worldId"] = 1;
+	js["runId"] = "35841";
+	js["reward"] = -0.1;
+	js["scoreIncrement"] = -0.1;
+	js["newState"] = {{"x", "12"}, {"y", 34}};
+	return js.dump();
+}
+
+// Same shape as GridExplorer::save() writes to world_<id>_mapv2.json.
+static string makeWorldSnapshot() {
+	mt19937 rng(1447);
+	uniform_real_distribution<double> reward(-1.0, 1.0);
+	json world = json::array();
+	json knownCells = json::array();
+	for (int i = 0; i < GRID_SIZE; i++) {
+		json row = json::array();
+		for (int j = 0; j < GRID_SIZE; j++) {
+			json cell;
+			for (int dir = 0; dir < A; dir++) {
+				cell["transitions"].push_back({{"x", i}, {"y", j}});
+				cell["explored"].push_back(int(rng() % 3));
+				cell["rewards"].push_back(reward(rng));
+			}
+			row.push_back(cell);
+			knownCells.push_back(to_string(i) + ":" + to_string(j));
+		}
+		world.push_back(row);
+	}
+	json saveData;
+	saveData["world"] = world;
+	saveData["knownCells"] = knownCells;
+	saveData["targetFound"] = false;
+	saveData["targetPos"] = {-1, -1};
+	saveData["targetMove"] = '-';
+	return saveData.dump(2);
+}
+
+// Same shape as QAgent's Q: one row of A action values per state, untouched entries still 1.0.
+static vector<vector<double> > makeQValues() {
+	mt19937 rng(3671);
+	uniform_real_distribution<double> q(-10.0, 10.0);
+	vector<vector<double> > tab(GRID_SIZE * GRID_SIZE, vector<double>(A));
+	for (auto &row : tab)
+		for (double &v : row) v = rng() % 4 ? q(rng) : 1.0;
+	return tab;
+}
+
+// Same shape as world_<id>_tab.json.
+static string makeQTable() {
+	json js;
+	js["Q"] = makeQValues();
+	return js.dump();
+}
+
+// Same as GridExplorer::knownCells once most of the grid has been visited.
+static unordered_set<string> makeKnownCells() {
+	mt19937 rng(2719);
+	unordered_set<string> cells;
+	for (int i = 0; i < GRID_SIZE; i++)
+		for (int j = 0; j < GRID_SIZE; j++)
+			if (rng() % 8) cells.insert(to_string(i) + ":" + to_string(j));
+	return cells;
+}
+
+// Mirrors main.cpp's Cell so save() can be timed through the DOM and through jsonWriter.
+struct Cell {
+	pair<int, int> transitions[A];
+	int explored[A] = { 0 };
+	double rewards[A] = { 0 };
+};
+
+static void to_json(json &j, const Cell &c) {
+	for (int i = 0; i < A; ++i) {
+		j["transitions"].push_back({{"x", c.transitions[i].first}, {"y", c.transitions[i].second}});
+		j["explored"].push_back(c.explored[i]);
+		j["rewards"].push_back(c.rewards[i]);
+	}
+}
+
+static void from_json(const json &j, Cell &c) {
+	for (int i = 0; i < A; ++i) {
+		c.transitions[i] = { j["transitions"][i]["x"], j["transitions"][i]["y"] };
+		c.explored[i] = j["explored"][i];
+		c.rewards[i] = j["rewards"][i];
+	}
+}
+
+static void write(jsonWriter &w, const Cell &c) {
+	w.begin_object();
+	w.key("explored").value(c.explored);
+	w.key("rewards").value(c.rewards);
+	w.key("transitions").begin_array();
+	for (int i = 0; i < A; ++i)
+		w.begin_object().key("x").value(c.transitions[i].first).key("y").value(c.transitions[i].second).end_object();
+	w.end_array();
+	w.end_object();
+}
+
+static vector<vector<Cell> > makeCells(const string &snapshot) {
+	json js = json::parse(snapshot);
+	vector<vector<Cell> > cells(GRID_SIZE, vector<Cell>(GRID_SIZE));
+	for (int i = 0; i < GRID_SIZE; i++)
+		for (int j = 0; j < GRID_SIZE; j++)
+			for (int k = 0; k < A; k++) {
+				const json &cell = js["world"][i][j];
+				cells[i][j].transitions[k] = { cell["transitions"][k]["x"], cell["transitions"][k]["y"] };
+				cells[i][j].explored[k] = cell["explored"][k];
+				cells[i][j].rewards[k] = cell["rewards"][k];
+			}
+	return cells;
+}
+
+// Same layout as GridExplorer::saveCheckpoint(): the grid as packed typed arrays in a CBOR map.
+static vector<uint8_t> writeCheckpoint(const vector<vector<Cell> > &cells) {
+	vector<int32_t> transitions, explored;
+	vector<double> rewards;
+	for (const auto &row : cells)
+		for (const Cell &cell : row)
+			for (int k = 0; k < A; k++) {
+				transitions.push_back(cell.transitions[k].first);
+				transitions.push_back(cell.transitions[k].second);
+				explored.push_back(cell.explored[k]);
+				rewards.push_back(cell.rewards[k]);
+			}
+	json js;
+	js["rows"] = cells.size();
+	js["cols"] = cells[0].size();
+	js["transitions"] = packTypedArray(transitions);
+	js["explored"] = packTypedArray(explored);
+	js["rewards"] = packTypedArray(rewards);
+	return json::to_cbor(js);
+}
+
+static vector<vector<Cell> > readCheckpoint(const vector<uint8_t> &bytes) {
+	json js = json::from_cbor(bytes, true, true, json::cbor_tag_handler_t::store);
+	vector<int32_t> transitions = unpackTypedArray<int32_t>(js["transitions"].get_binary());
+	vector<int32_t> explored = unpackTypedArray<int32_t>(js["explored"].get_binary());
+	vector<double> rewards = unpackTypedArray<double>(js["rewards"].get_binary());
+	vector<vector<Cell> > cells(js["rows"].get<size_t>(), vector<Cell>(js["cols"].get<size_t>()));
+	size_t at = 0;
+	for (auto &row : cells)
+		for (Cell &cell : row)
+			for (int k = 0; k < A; k++, at++) {
+				cell.transitions[k] = { transitions[at * 2], transitions[at * 2 + 1] };
+				cell.explored[k] = explored[at];
+				cell.rewards[k] = rewards[at];
+			}
+	return cells;
+}
+
+// Only cases whose name contains this run; empty runs everything.
+static string filter;
+
+// bytes is the size of the document the case reads or writes, in whatever format it uses.
+template <typename F>
+static void run(const char *name, size_t bytes, int iterations, F &&body) {
+	if (!filter.empty() && string(name).find(filter) == string::npos) return;
+	body(); // warm-up
+	size_t allocated = allocations.load(memory_order_relaxed);
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) body();
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	allocated = allocations.load(memory_order_relaxed) - allocated;
+	double mbps = double(bytes) * iterations / sec / (1024.0 * 1024.0);
+	printf("%-36s %10.0f ns/op %10.1f MB/s %10.1f allocs/op\n", name, sec * 1e9 / iterations, mbps,
+		double(allocated) / iterations);
+}
+
+// Encode and decode of one value as text, CBOR and MessagePack, starting from the typed value the
+// agent holds (the conversions to and from json are part of what is timed).
+template <typename T>
+static void roundTrips(const char *fixture, const T &value, int iterations, size_t &sink) {
+	const json doc = value;
+	const string text = doc.dump();
+	const vector<uint8_t> cbor = json::to_cbor(doc), msgpack = json::to_msgpack(doc);
+	string name;
+	auto label = [&](const char *what) {
+		name = string(fixture) + " / " + what;
+		return name.c_str();
+	};
+	run(label("dump"), text.size(), iterations, [&] { sink += json(value).dump().size(); });
+	run(label("parse"), text.size(), iterations, [&] { sink += json::parse(text).get<T>().size(); });
+	run(label("to_cbor"), cbor.size(), iterations, [&] { sink += json::to_cbor(json(value)).size(); });
+	run(label("from_cbor"), cbor.size(), iterations, [&] { sink += json::from_cbor(cbor).get<T>().size(); });
+	run(label("to_msgpack"), msgpack.size(), iterations, [&] { sink += json::to_msgpack(json(value)).size(); });
+	run(label("from_msgpack"), msgpack.size(), iterations, [&] { sink += json::from_msgpack(msgpack).get<T>().size(); });
+}
+
+static void writeFixture(const string &dir, const string &name, const string &text) {
+	ofstream file(dir + "/" + name, ios::binary);
+	file << text;
+	if (!file) {
+		fprintf(stderr, "cannot write %s/%s\n", dir.c_str(), name.c_str());
+		exit(1);
+	}
+}
+
+int main(int argc, char **argv) {
+	const string move = makeMoveResponse();
+	const string world = makeWorldSnapshot();
+	const string qtab = makeQTable();
+	const unordered_set<string> knownCells = makeKnownCells();
+	if (argc == 3 && string(argv[1]) == "--fixtures") {
+		writeFixture(argv[2], "move.json", move);
+		writeFixture(argv[2], "world_mapv2.json", world);
+		writeFixture(argv[2], "world_tab.json", qtab);
+		writeFixture(argv[2], "knownCells.json", json(knownCells).dump());
+		return 0;
+	}
+	if (argc == 2) filter = argv[1];
+	else if (argc > 2) {
+		fprintf(stderr, "usage: %s [name filter] | --fixtures <dir>\n", argv[0]);
+		return 2;
+	}
+	printf("gw.php response: %zu bytes, world snapshot: %zu bytes, Q table: %zu bytes\n\n", move.size(), world.size(),
+		qtab.size());
+
+	size_t sink = 0;
+	run("parse move / json", move.size(), 200000, [&] { sink += json::parse(move).size(); });
+	run("parse move / arenaDocument", move.size(), 200000, [&] {
+		arenaDocument doc(4 * 1024);
+		sink += doc.parse(move).size();
+	});
+	{
+		arenaDocument doc(4 * 1024);
+		run("parse move / arenaDocument reset", move.size(), 200000, [&] {
+			doc.reset();
+			sink += doc.parse(move).size();
+		});
+	}
+	run("parse move / flatJson", move.size(), 200000, [&] { sink += flatJson::parse(move).size(); });
+	run("view move / newState", move.size(), 200000, [&] {
+		jsonIndex doc(move);
+		jsonView state = doc.root()["newState"];
+		sink += state["y"].get<int>() + state["x"].get<string>().size();
+	});
+	{
+		const json moveJson = json::parse(move);
+		jsonIndex moveIndex(move);
+		const pathSet<json> fields = {"/reward", "/newState/x", "/newState/y"};
+		vector<const json *> found;
+		vector<optional<jsonView> > foundViews;
+		run("fields move / json operator[]", move.size(), 2000000, [&] {
+			sink += moveJson["reward"].is_number() + moveJson["newState"]["x"].is_string() + moveJson["newState"]["y"].is_number();
+		});
+		run("fields move / json pathSet", move.size(), 2000000, [&] {
+			fields.extract(moveJson, found);
+			sink += found[0]->is_number() + found[1]->is_string() + found[2]->is_number();
+		});
+		run("fields move / view operator[]", move.size(), 2000000, [&] {
+			jsonView root = moveIndex.root();
+			sink += root["reward"].is_number() + root["newState"]["x"].is_string() + root["newState"]["y"].is_number();
+		});
+		run("fields move / view pathSet", move.size(), 2000000, [&] {
+			fields.extract(moveIndex.root(), foundViews);
+			sink += foundViews[0]->is_number() + foundViews[1]->is_string() + foundViews[2]->is_number();
+		});
+		jsonIndex reused;
+		run("fields move / reused index", move.size(), 200000, [&] {
+			reused.parse(move);
+			fields.extract(reused.root(), foundViews);
+			sink += foundViews[0]->is_number() + foundViews[1]->is_string() + foundViews[2]->is_number();
+		});
+	}
+	run("accept world / lexer only", world.size(), 100, [&] { sink += json::accept(world); });
+	run("parse world / json", world.size(), 100, [&] { sink += json::parse(world).size(); });
+	const string worldPath = "json_bench_world.json";
+	ofstream(worldPath, ios::binary) << world;
+	run("load world / ifstream", world.size(), 100, [&] {
+		ifstream file(worldPath);
+		json js;
+		file >> js;
+		sink += js.size();
+	});
+	run("load world / mappedFile", world.size(), 100, [&] {
+		mappedFile file(worldPath);
+		sink += json::parse(file).size();
+	});
+	remove(worldPath.c_str());
+	run("parse world / parallelParse", world.size(), 100, [&] {
+		sink += parallelParse(world, json::json_pointer("/world"), 0, 0).size();
+	});
+	run("parse world / parallelParse x4", world.size(), 100, [&] {
+		sink += parallelParse(world, json::json_pointer("/world"), 4, 0).size();
+	});
+	run("parse world / flatJson", world.size(), 100, [&] { sink += flatJson::parse(world).size(); });
+	run("parse world / internedDocument", world.size(), 100, [&] {
+		internedDocument doc;
+		sink += doc.parse(world).size();
+	});
+	run("parse world / arenaDocument", world.size(), 100, [&] {
+		arenaDocument doc(1024 * 1024);
+		sink += doc.parse(world).size();
+	});
+	const json worldJson = json::parse(world);
+	const flatJson worldFlat = flatJson::parse(world);
+	run("lookup world / json", world.size(), 100, [&] {
+		double total = 0;
+		for (const json &row : worldJson["world"])
+			for (const json &cell : row)
+				total += cell["rewards"][0].get<double>() + cell["transitions"][1]["y"].get<int>();
+		sink += total != 0;
+	});
+	run("lookup world / flatJson", world.size(), 100, [&] {
+		double total = 0;
+		for (const flatJson &row : worldFlat["world"])
+			for (const flatJson &cell : row)
+				total += cell["rewards"][0].get<double>() + cell["transitions"][1]["y"].get<int>();
+		sink += total != 0;
+	});
+	run("view world / rewards per row", world.size(), 100, [&] {
+		jsonIndex doc(world);
+		double total = 0;
+		for (jsonView row : doc.root()["world"])
+			for (jsonView cell : row) total += cell["rewards"][0].get<double>();
+		sink += total != 0;
+	});
+	run("dump world / json", world.size(), 100, [&] { sink += worldJson.dump(2).size(); });
+	const json qJson = json::parse(qtab);
+	run("dump Q table / json", qtab.size(), 100, [&] { sink += qJson.dump().size(); });
+	const vector<vector<Cell> > cells = makeCells(world);
+	run("save world / to_json + dump", world.size(), 100, [&] {
+		json saveData;
+		saveData["world"] = cells;
+		sink += saveData.dump(2).size();
+	});
+	run("save world / jsonWriter", world.size(), 100, [&] {
+		string out;
+		{
+			jsonWriter saveData(out, 2);
+			saveData.begin_object().key("world").value(cells).end_object();
+		}
+		sink += out.size();
+	});
+	{
+		patchJournal<json> journal;
+		json snapshot;
+		snapshot["world"] = cells;
+		journal.open("json_bench_journal.json", "json_bench_journal.log");
+		journal.reset(snapshot);
+		vector<vector<Cell> > live = cells;
+		int step = 0;
+		run("save step / patchJournal", world.size(), 10000, [&] {
+			int x = step % GRID_SIZE, y = (step / GRID_SIZE) % GRID_SIZE;
+			live[x][y].explored[step % A]++;
+			journal.update(json::json_pointer("/world/" + to_string(x) + "/" + to_string(y)), live[x][y]);
+			step++;
+		});
+		journal.flush();
+		remove("json_bench_journal.json");
+		remove("json_bench_journal.log");
+	}
+	const vector<uint8_t> checkpoint = writeCheckpoint(cells);
+	json worldOnly;
+	worldOnly["world"] = cells;
+	const vector<uint8_t> plainCbor = json::to_cbor(worldOnly);
+	if (json(readCheckpoint(checkpoint)) != json(cells)) printf("checkpoint round trip mismatch\n");
+	printf("grid as text: %zu bytes, as CBOR: %zu bytes, as typed-array checkpoint: %zu bytes\n",
+		worldOnly.dump(2).size(), plainCbor.size(), checkpoint.size());
+	run("save world / to_cbor of DOM", world.size(), 100, [&] {
+		json saveData;
+		saveData["world"] = cells;
+		sink += json::to_cbor(saveData).size();
+	});
+	run("save world / checkpoint", world.size(), 100, [&] { sink += writeCheckpoint(cells).size(); });
+	run("load world / from_cbor to DOM", world.size(), 100, [&] {
+		sink += json::from_cbor(plainCbor)["world"].get<vector<vector<Cell> > >().size();
+	});
+	run("load world / checkpoint", world.size(), 100, [&] { sink += readCheckpoint(checkpoint).size(); });
+	run("accept Q table / lexer only", qtab.size(), 100, [&] { sink += json::accept(qtab); });
+	run("parse Q table / json", qtab.size(), 100, [&] { sink += json::parse(qtab).size(); });
+	run("parse Q table / parallelParse x4", qtab.size(), 100, [&] {
+		sink += parallelParse(qtab, json::json_pointer("/Q"), 4, 0).size();
+	});
+	run("parse Q table / flatJson", qtab.size(), 100, [&] { sink += flatJson::parse(qtab).size(); });
+
+	roundTrips("move", json::parse(move), 100000, sink);
+	roundTrips("world cells", cells, 50, sink);
+	roundTrips("knownCells", knownCells, 200, sink);
+	roundTrips("Q values", makeQValues(), 100, sink);
+
+	return sink == 0;
+}
@@ -0,0 +1,225 @@
+#ifndef JDEVTOOLS_JDEVARENA_HPP
+#define JDEVTOOLS_JDEVARENA_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jdevtools {
+	// Bump allocator that hands out memory from a list of growing chunks.
+	// Nothing is freed individually; release() (or the destructor) drops every chunk at once.
+	class monotonicArena {
+		struct chunk {
+			chunk *next;
+			std::size_t size;
+		};
+
+		chunk *head = nullptr;
+		char *cur = nullptr;
+		char *end = nullptr;
+		std::size_t nextSize;
+		std::size_t used = 0;
+
+		void grow(std::size_t bytes, std::size_t align) {
+			std::size_t need = sizeof(chunk) + bytes + align;
+			std::size_t size = nextSize > need ? nextSize : need;
+			chunk *c = static_cast<chunk *>(::operator new(size));
+			c->next = head;
+			c->size = size;
+			head = c;
+			cur = reinterpret_cast<char *>(c + 1);
+			end = reinterpret_cast<char *>(c) + size;
+			nextSize = size * 2;
+		}
+
+	public:
+		explicit monotonicArena(std::size_t initialSize = 64 * 1024) : nextSize(initialSize) {}
+		monotonicArena(const monotonicArena &) = delete;
+		monotonicArena &operator=(const monotonicArena &) = delete;
+		~monotonicArena() { release(); }
+
+		void *allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) {
+			std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(cur) + align - 1) & ~(std::uintptr_t)(align - 1);
+			if (!head || p + bytes > reinterpret_cast<std::uintptr_t>(end)) {
+				grow(bytes, align);
+				p = (reinterpret_cast<std::uintptr_t>(cur) + align - 1) & ~(std::uintptr_t)(align - 1);
+			}
+			cur = reinterpret_cast<char *>(p + bytes);
+			used += bytes;
+			return reinterpret_cast<void *>(p);
+		}
+
+		// Only the most recent allocation can be given back (vector growth, temporary strings).
+		void deallocate(void *p, std::size_t bytes) {
+			if (static_cast<char *>(p) + bytes == cur) {
+				cur = static_cast<char *>(p);
+				used -= bytes;
+			}
+		}
+
+		bool owns(const void *p) const {
+			for (const chunk *c = head; c; c = c->next) {
+				const char *begin = reinterpret_cast<const char *>(c);
+				if (p >= begin && p < begin + c->size) return true;
+			}
+			return false;
+		}
+
+		// Forgets every allocation but keeps the newest (largest) chunk for reuse, so a document
+		// parsed again and again into the same arena stops allocating once the chunk fits it.
+		void rewind() {
+			if (!head) return;
+			while (head->next) {
+				chunk *older = head->next;
+				head->next = older->next;
+				::operator delete(older);
+			}
+			cur = reinterpret_cast<char *>(head + 1);
+			end = reinterpret_cast<char *>(head) + head->size;
+			nextSize = head->size;
+			used = 0;
+		}
+
+		void release() {
+			while (head) {
+				chunk *next = head->next;
+				::operator delete(head);
+				head = next;
+			}
+			cur = end = nullptr;
+			used = 0;
+		}
+
+		std::size_t bytesUsed() const { return used; }
+		std::size_t bytesReserved() const {
+			std::size_t total = 0;
+			for (const chunk *c = head; c; c = c->next) total += c->size;
+			return total;
+		}
+
+		// Arena that arenaAllocator draws from on this thread, or nullptr for the global heap.
+		static monotonicArena *&current() {
+			thread_local monotonicArena *arena = nullptr;
+			return arena;
+		}
+	};
+
+	// Makes an arena current for the lifetime of the scope and restores the previous one afterwards.
+	class arenaScope {
+		monotonicArena *previous;
+
+	public:
+		explicit arenaScope(monotonicArena &arena) : previous(monotonicArena::current()) {
+			monotonicArena::current() = &arena;
+		}
+		arenaScope(const arenaScope &) = delete;
+		arenaScope &operator=(const arenaScope &) = delete;
+		~arenaScope() { monotonicArena::current() = previous; }
+	};
+
+	// Stateless allocator over the current thread's arena. nlohmann::basic_json default-constructs
+	// its allocators, so the arena has to be found through monotonicArena::current() when
+	// allocating; outside any arenaScope it allocates from the global heap. Every block is preceded
+	// by the arena it came from (nullptr for the heap), so a value built inside a scope can still be
+	// modified or destroyed outside it, on the same thread, for as long as its arena lives.
+	template <typename T>
+	struct arenaAllocator {
+		using value_type = T;
+
+		arenaAllocator() noexcept = default;
+		template <typename U>
+		arenaAllocator(const arenaAllocator<U> &) noexcept {}
+
+		T *allocate(std::size_t n) {
+			const std::size_t bytes = header + n * sizeof(T);
+			monotonicArena *arena = monotonicArena::current();
+			char *block = static_cast<char *>(arena ? arena->allocate(bytes, header) : ::operator new(bytes));
+			*reinterpret_cast<monotonicArena **>(block) = arena;
+			return reinterpret_cast<T *>(block + header);
+		}
+
+		void deallocate(T *p, std::size_t n) noexcept {
+			char *block = reinterpret_cast<char *>(p) - header;
+			if (monotonicArena *arena = *reinterpret_cast<monotonicArena **>(block))
+				arena->deallocate(block, header + n * sizeof(T));
+			else ::operator delete(block);
+		}
+
+		template <typename U>
+		bool operator==(const arenaAllocator<U> &) const noexcept { return true; }
+		template <typename U>
+		bool operator!=(const arenaAllocator<U> &) const noexcept { return false; }
+
+	private:
+		// room for the owner pointer that keeps the block after it aligned for T
+		static constexpr std::size_t header = alignof(T) > sizeof(void *) ? alignof(T) : sizeof(void *);
+	};
+
+	using arenaString = std::basic_string<char, std::char_traits<char>, arenaAllocator<char> >;
+
+	// basic_json whose objects, arrays, strings and binaries all live in the current arena.
+	using arenaJson = nlohmann::basic_json<std::map, std::vector, arenaString, bool, std::int64_t, std::uint64_t, double,
+		arenaAllocator, nlohmann::adl_serializer, std::vector<std::uint8_t, arenaAllocator<std::uint8_t> > >;
+
+	// Owns an arena and a single arenaJson parsed into it.
+	// Whatever the tree allocates under scope() belongs to the arena and is freed with its chunks.
+	// Changes made outside scope() take heap blocks, so the tree is destroyed before the arena is
+	// rewound or dropped; freeing arena blocks then costs nothing beyond the walk over the tree.
+	class arenaDocument {
+		monotonicArena mem;
+		arenaJson *rootValue = nullptr;
+
+		void destroy() {
+			if (!rootValue) return;
+			rootValue->~arenaJson();
+			rootValue = nullptr;
+		}
+
+	public:
+		explicit arenaDocument(std::size_t initialSize = 64 * 1024) : mem(initialSize) {}
+		arenaDocument(const arenaDocument &) = delete;
+		arenaDocument &operator=(const arenaDocument &) = delete;
+		~arenaDocument() { destroy(); }
+
+		template <typename InputType>
+		arenaJson &parse(InputType &&input) {
+			destroy();
+			arenaScope scope(mem);
+			void *storage = mem.allocate(sizeof(arenaJson), alignof(arenaJson));
+			rootValue = new (storage) arenaJson(arenaJson::parse(std::forward<InputType>(input)));
+			return *rootValue;
+		}
+
+		template <typename IteratorType>
+		arenaJson &parse(IteratorType first, IteratorType last) {
+			destroy();
+			arenaScope scope(mem);
+			void *storage = mem.allocate(sizeof(arenaJson), alignof(arenaJson));
+			rootValue = new (storage) arenaJson(arenaJson::parse(first, last));
+			return *rootValue;
+		}
+
+		// Drops the tree and rewinds the arena without returning its memory, for a document that
+		// is parsed again for every response. References into the old tree are invalidated.
+		void reset() {
+			destroy();
+			mem.rewind();
+		}
+
+		// Modifying the tree allocates; under this scope the new blocks come from the arena too.
+		arenaScope scope() { return arenaScope(mem); }
+
+		arenaJson &root() { return *rootValue; }
+		const arenaJson &root() const { return *rootValue; }
+		bool empty() const { return rootValue == nullptr; }
+		monotonicArena &arena() { return mem; }
+	};
+}
+
+#endif
@@ -11,20 +11,27 @@ namespace {
 #define pclose _pclose
 #endif
 
-	inline std::string exec(const char* cmd) {
-		char buffer[128];
-		std::string result = "";
+	// Replaces result with the command's output; result keeps its capacity between calls.
+	inline void exec(const char* cmd, std::string &result) {
+		char buffer[4096];
+		result.clear();
 		FILE* pipe = popen(cmd, "r");
 		if (!pipe) throw std::runtime_error("popen() failed!");
 		try {
-			while (fgets(buffer, sizeof buffer, pipe) != NULL) {
-				result += buffer;
+			size_t n;
+			while ((n = fread(buffer, 1, sizeof buffer, pipe)) > 0) {
+				result.append(buffer, n);
 			}
 		} catch (...) {
 			pclose(pipe);
 			throw;
 		}
 		pclose(pipe);
+	}
+
+	inline std::string exec(const char* cmd) {
+		std::string result;
+		exec(cmd, result);
 		return result;
 	}
 }
@@ -39,19 +46,29 @@ namespace jdevtools {
 		std::vector<std::string> urlEncodeData;
 	};
 
-	inline std::string sender(const requestData &req, bool isPost = false) {
-		std::string command = "curl -s -o -";
-		if (isPost) command += " -X POST \"" + req.url + '"';
-		else command += " --location \"" + req.url + '"';
+	// Writes the response into response. The command line is built in a per-thread buffer and
+	// response keeps its capacity, so a loop reusing both makes no allocations once warmed up
+	// (popen itself still mallocs inside the C library).
+	inline void sender(const requestData &req, std::string &response, bool isPost = false) {
+		thread_local std::string command;
+		command = "curl -s -o -";
+		if (isPost) command.append(" -X POST \"").append(req.url) += '"';
+		else command.append(" --location \"").append(req.url) += '"';
 		for (int i = 0; i < req.headers.size(); i++) {
-			command += " -H \"" + req.headers[i] + '"';
+			command.append(" -H \"").append(req.headers[i]) += '"';
 		}
-		if (req.postData.size()) command += " -d \"" + req.postData + '"';
+		if (req.postData.size()) command.append(" -d \"").append(req.postData) += '"';
 		for (int i = 0; i < req.urlEncodeData.size(); i++) {
-			command += " --data-urlencode \"" + req.urlEncodeData[i] + '"';
+			command.append(" --data-urlencode \"").append(req.urlEncodeData[i]) += '"';
 		}
 		// std::cout << command << '\n';
-		return exec(command.data());
+		exec(command.data(), response);
+	}
+
+	inline std::string sender(const requestData &req, bool isPost = false) {
+		std::string response;
+		sender(req, response, isPost);
+		return response;
 	}
 }
 
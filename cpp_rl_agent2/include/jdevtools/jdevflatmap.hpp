@@ -0,0 +1,339 @@
+#ifndef JDEVTOOLS_JDEVFLATMAP_HPP
+#define JDEVTOOLS_JDEVFLATMAP_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jdevtools {
+	// Object container for nlohmann::basic_json, selectable through the ObjectType parameter
+	// (see flatJson below). Entries are kept contiguously in insertion order; the first few live
+	// in a buffer inside the map itself, so small objects like {"x":..,"y":..} cost no allocation
+	// beyond the one basic_json already makes for the object. Lookups are a linear scan up to
+	// hashThreshold entries, above that an open-addressing index of entry positions is kept.
+	//
+	// Keys must be string-like (convertible to std::string_view). Like nlohmann::ordered_map,
+	// inserting can move entries, so references into the map do not survive an insert, and
+	// dump() writes keys in insertion order rather than sorted.
+	template <class Key, class T, class IgnoredLess = std::less<Key>,
+		class Allocator = std::allocator<std::pair<const Key, T> > >
+	class flatMap {
+	public:
+		using key_type = Key;
+		using mapped_type = T;
+		using value_type = std::pair<const Key, T>;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = value_type &;
+		using const_reference = const value_type &;
+		using iterator = value_type *;
+		using const_iterator = const value_type *;
+		using allocator_type = Allocator;
+		using key_compare = std::equal_to<>;
+
+		// Sized in bytes because T is still incomplete when basic_json names this type: room for
+		// four entries, counting a basic_json as 16 bytes (192 bytes with std::string keys).
+		static constexpr size_type inlineBytes = 4 * (sizeof(Key) + 16);
+		static constexpr size_type hashThreshold = 8;
+
+	private:
+		using traits = std::allocator_traits<Allocator>;
+		using indexAllocator = typename traits::template rebind_alloc<std::uint32_t>;
+
+		alignas(std::max_align_t) unsigned char inlineStorage[inlineBytes];
+		value_type *items;
+		size_type length = 0;
+		size_type cap;
+		// 0 marks an empty slot, otherwise entry position + 1; empty while length <= hashThreshold
+		std::vector<std::uint32_t, indexAllocator> index;
+		Allocator alloc;
+
+		static constexpr size_type inlineCount() { return inlineBytes / sizeof(value_type); }
+
+		value_type *inlineItems() { return reinterpret_cast<value_type *>(inlineStorage); }
+		bool isInline() const { return items == reinterpret_cast<const value_type *>(inlineStorage); }
+
+		template <typename K>
+		static std::size_t hashKey(const K &key) {
+			return std::hash<std::string_view>()(std::string_view(key));
+		}
+
+		void indexInsert(size_type pos) {
+			const std::size_t mask = index.size() - 1;
+			std::size_t slot = hashKey(items[pos].first) & mask;
+			while (index[slot]) slot = (slot + 1) & mask;
+			index[slot] = static_cast<std::uint32_t>(pos + 1);
+		}
+
+		void rebuildIndex() {
+			index.clear();
+			if (length <= hashThreshold) return;
+			size_type slots = 16;
+			while (slots < length * 2) slots *= 2;
+			index.assign(slots, 0);
+			for (size_type i = 0; i < length; ++i) indexInsert(i);
+		}
+
+		template <typename K>
+		size_type position(const K &key) const {
+			if (index.empty()) {
+				for (size_type i = 0; i < length; ++i)
+					if (items[i].first == key) return i;
+				return length;
+			}
+			const std::size_t mask = index.size() - 1;
+			for (std::size_t slot = hashKey(key) & mask; index[slot]; slot = (slot + 1) & mask) {
+				size_type i = index[slot] - 1;
+				if (items[i].first == key) return i;
+			}
+			return length;
+		}
+
+		// Entries are relocated by construct + destroy; keys are const, so they are copied.
+		void relocate(value_type *to) {
+			for (size_type i = 0; i < length; ++i) {
+				traits::construct(alloc, to + i, std::move(items[i]));
+				traits::destroy(alloc, items + i);
+			}
+		}
+
+		void freeStorage() {
+			if (!isInline()) traits::deallocate(alloc, items, cap);
+			items = inlineItems();
+			cap = inlineCount();
+		}
+
+		// Constructs the new entry before moving the old ones, so args may refer into the map.
+		template <typename... Args>
+		value_type *append(Args &&...args) {
+			if (length == cap) {
+				size_type newCap = cap ? cap * 2 : 4;
+				value_type *fresh = traits::allocate(alloc, newCap);
+				try {
+					traits::construct(alloc, fresh + length, std::forward<Args>(args)...);
+				} catch (...) {
+					traits::deallocate(alloc, fresh, newCap);
+					throw;
+				}
+				relocate(fresh);
+				if (!isInline()) traits::deallocate(alloc, items, cap);
+				items = fresh;
+				cap = newCap;
+			} else {
+				traits::construct(alloc, items + length, std::forward<Args>(args)...);
+			}
+			++length;
+			if (length > hashThreshold) {
+				if (index.size() < length * 2) rebuildIndex();
+				else indexInsert(length - 1);
+			}
+			return items + length - 1;
+		}
+
+		void takeFrom(flatMap &&other) {
+			if (other.isInline()) {
+				for (size_type i = 0; i < other.length; ++i) append(std::move(other.items[i]));
+				other.clear();
+			} else {
+				items = other.items;
+				cap = other.cap;
+				length = other.length;
+				index = std::move(other.index);
+				other.items = other.inlineItems();
+				other.cap = inlineCount();
+				other.length = 0;
+				other.index.clear();
+			}
+		}
+
+	public:
+		flatMap() noexcept : items(inlineItems()), cap(inlineCount()) {
+			static_assert(alignof(value_type) <= alignof(std::max_align_t), "flatMap entries are over-aligned");
+		}
+		explicit flatMap(const Allocator &a) noexcept : flatMap() { alloc = a; }
+		template <class It>
+		flatMap(It first, It last, const Allocator &a = Allocator()) : flatMap(a) {
+			insert(first, last);
+		}
+		flatMap(std::initializer_list<value_type> init, const Allocator &a = Allocator()) : flatMap(a) {
+			insert(init.begin(), init.end());
+		}
+		flatMap(const flatMap &other) : flatMap(other.alloc) {
+			reserve(other.length);
+			for (const value_type &item : other) append(item);
+		}
+		flatMap(flatMap &&other) : flatMap(other.alloc) { takeFrom(std::move(other)); }
+		flatMap &operator=(const flatMap &other) {
+			if (this != &other) {
+				clear();
+				reserve(other.length);
+				for (const value_type &item : other) append(item);
+			}
+			return *this;
+		}
+		flatMap &operator=(flatMap &&other) {
+			if (this != &other) {
+				clear();
+				freeStorage();
+				takeFrom(std::move(other));
+			}
+			return *this;
+		}
+		~flatMap() {
+			clear();
+			freeStorage();
+		}
+
+		iterator begin() noexcept { return items; }
+		iterator end() noexcept { return items + length; }
+		const_iterator begin() const noexcept { return items; }
+		const_iterator end() const noexcept { return items + length; }
+		const_iterator cbegin() const noexcept { return items; }
+		const_iterator cend() const noexcept { return items + length; }
+
+		size_type size() const noexcept { return length; }
+		bool empty() const noexcept { return length == 0; }
+		size_type max_size() const noexcept { return traits::max_size(alloc); }
+		// basic_json detects ordered_map-like containers by this member (JSON_DIAGNOSTICS parent tracking).
+		size_type capacity() const noexcept { return cap; }
+
+		void reserve(size_type n) {
+			if (n <= cap) return;
+			value_type *fresh = traits::allocate(alloc, n);
+			relocate(fresh);
+			if (!isInline()) traits::deallocate(alloc, items, cap);
+			items = fresh;
+			cap = n;
+		}
+
+		void clear() noexcept {
+			for (size_type i = 0; i < length; ++i) traits::destroy(alloc, items + i);
+			length = 0;
+			index.clear();
+		}
+
+		template <class KeyType, class V>
+		std::pair<iterator, bool> emplace(KeyType &&key, V &&value) {
+			size_type i = position(key);
+			if (i != length) return { items + i, false };
+			return { append(std::forward<KeyType>(key), std::forward<V>(value)), true };
+		}
+
+		std::pair<iterator, bool> insert(const value_type &value) {
+			size_type i = position(value.first);
+			if (i != length) return { items + i, false };
+			return { append(value), true };
+		}
+		std::pair<iterator, bool> insert(value_type &&value) {
+			size_type i = position(value.first);
+			if (i != length) return { items + i, false };
+			return { append(std::move(value)), true };
+		}
+		template <typename InputIt, typename = decltype(*std::declval<InputIt &>(), ++std::declval<InputIt &>())>
+		void insert(InputIt first, InputIt last) {
+			for (; first != last; ++first) {
+				const auto &item = *first;
+				if (position(item.first) == length) append(item);
+			}
+		}
+
+		template <class KeyType>
+		T &operator[](KeyType &&key) {
+			return emplace(std::forward<KeyType>(key), T{}).first->second;
+		}
+		T &operator[](const key_type &key) { return emplace(key, T{}).first->second; }
+		template <class KeyType>
+		const T &operator[](const KeyType &key) const {
+			return at(key);
+		}
+
+		template <class KeyType>
+		T &at(const KeyType &key) {
+			size_type i = position(key);
+			if (i == length) throw std::out_of_range("key not found");
+			return items[i].second;
+		}
+		template <class KeyType>
+		const T &at(const KeyType &key) const {
+			size_type i = position(key);
+			if (i == length) throw std::out_of_range("key not found");
+			return items[i].second;
+		}
+
+		template <class KeyType>
+		iterator find(const KeyType &key) {
+			return items + position(key);
+		}
+		template <class KeyType>
+		const_iterator find(const KeyType &key) const {
+			return items + position(key);
+		}
+		template <class KeyType>
+		size_type count(const KeyType &key) const {
+			return position(key) != length ? 1 : 0;
+		}
+
+		// Removal keeps insertion order: later entries are rebuilt one slot earlier (keys are const).
+		iterator erase(const_iterator first, const_iterator last) {
+			size_type from = static_cast<size_type>(first - items);
+			size_type removed = static_cast<size_type>(last - first);
+			if (!removed) return items + from;
+			for (size_type i = from; i + removed < length; ++i) {
+				traits::destroy(alloc, items + i);
+				traits::construct(alloc, items + i, std::move(items[i + removed]));
+			}
+			for (size_type i = length - removed; i < length; ++i) traits::destroy(alloc, items + i);
+			length -= removed;
+			rebuildIndex();
+			return items + from;
+		}
+		iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+		iterator erase(iterator pos) { return erase(const_iterator(pos), const_iterator(pos + 1)); }
+		template <class KeyType, typename = std::enable_if_t<!std::is_convertible<KeyType, const_iterator>::value> >
+		size_type erase(const KeyType &key) {
+			size_type i = position(key);
+			if (i == length) return 0;
+			erase(const_iterator(items + i));
+			return 1;
+		}
+
+		allocator_type get_allocator() const { return alloc; }
+
+		// Equal when both hold the same keys with equal values, whatever their order.
+		friend bool operator==(const flatMap &a, const flatMap &b) {
+			if (a.length != b.length) return false;
+			for (const value_type &item : a) {
+				const_iterator other = b.find(item.first);
+				if (other == b.end() || !(other->second == item.second)) return false;
+			}
+			return true;
+		}
+		friend bool operator!=(const flatMap &a, const flatMap &b) { return !(a == b); }
+		// Lexicographic in insertion order, like nlohmann::ordered_map.
+		friend bool operator<(const flatMap &a, const flatMap &b) {
+			for (size_type i = 0; i < a.length && i < b.length; ++i) {
+				if (a.items[i] < b.items[i]) return true;
+				if (b.items[i] < a.items[i]) return false;
+			}
+			return a.length < b.length;
+		}
+		friend bool operator>(const flatMap &a, const flatMap &b) { return b < a; }
+		friend bool operator<=(const flatMap &a, const flatMap &b) { return !(b < a); }
+		friend bool operator>=(const flatMap &a, const flatMap &b) { return !(a < b); }
+	};
+
+	// basic_json whose objects are flatMaps; everything else is the nlohmann default.
+	using flatJson = nlohmann::basic_json<flatMap>;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef JDEVTOOLS_JDEVINTERN_HPP
+#define JDEVTOOLS_JDEVINTERN_HPP
+
+#include "jdevtools/jdevflatmap.hpp"
+#include "jdevtools/jdevparallel.hpp"
+#include "nlohmann/json.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace jdevtools {
+	// Holds one copy of every distinct key string. Keys handed out stay valid until the table is
+	// destroyed; nothing is ever removed.
+	class keyTable {
+		std::deque<std::string> strings;
+		std::unordered_map<std::string_view, const std::string *> lookup;
+		std::vector<std::unique_ptr<keyTable> > children;
+		std::mutex lock;
+		bool shared;
+
+	public:
+		explicit keyTable(bool shared = false) : shared(shared) {}
+		keyTable(const keyTable &) = delete;
+		keyTable &operator=(const keyTable &) = delete;
+
+		const std::string *intern(std::string_view key) {
+			std::unique_lock<std::mutex> guard(lock, std::defer_lock);
+			if (shared) guard.lock();
+			auto it = lookup.find(key);
+			if (it != lookup.end()) return it->second;
+			const std::string *s = &strings.emplace_back(key);
+			lookup.emplace(std::string_view(*s), s);
+			return s;
+		}
+
+		// A table owned by this one, for another thread to intern into without locking. Its keys
+		// stay valid as long as this table does; they equal this table's keys by content only.
+		keyTable &child() {
+			std::lock_guard<std::mutex> guard(lock);
+			children.push_back(std::make_unique<keyTable>());
+			return *children.back();
+		}
+
+		// keys held, child tables included; a key interned by several threads counts once per table
+		std::size_t size() const {
+			std::size_t n = strings.size();
+			for (const auto &c : children) n += c->size();
+			return n;
+		}
+
+		// Table that interned keys go to on this thread, or nullptr for global().
+		static keyTable *&current() {
+			thread_local keyTable *table = nullptr;
+			return table;
+		}
+
+		// Process-wide table for keys created outside any keyScope; it lives until exit.
+		static keyTable &global() {
+			static keyTable *table = new keyTable(true);
+			return *table;
+		}
+	};
+
+	// Makes a key table current for the lifetime of the scope, like arenaScope does for arenas.
+	class keyScope {
+		keyTable *previous;
+
+	public:
+		explicit keyScope(keyTable &table) : previous(keyTable::current()) { keyTable::current() = &table; }
+		keyScope(const keyScope &) = delete;
+		keyScope &operator=(const keyScope &) = delete;
+		~keyScope() { keyTable::current() = previous; }
+	};
+
+	// Object key that is a pointer to its string in a keyTable: 8 bytes instead of a 32-byte
+	// std::string, copied without touching the heap, and compared by address when both keys
+	// come from the same table.
+	class internedKey {
+		const std::string *s;
+
+		static const std::string *intern(std::string_view key) {
+			keyTable *table = keyTable::current();
+			return (table ? *table : keyTable::global()).intern(key);
+		}
+
+	public:
+		internedKey() : s(intern(std::string_view())) {}
+		explicit internedKey(std::string_view key) : s(intern(key)) {}
+		explicit internedKey(const std::string &key) : s(intern(key)) {}
+		explicit internedKey(const char *key) : s(intern(key)) {}
+
+		const std::string &str() const { return *s; }
+		operator const std::string &() const { return *s; }
+		explicit operator std::string_view() const { return *s; }
+
+		const char *c_str() const { return s->c_str(); }
+		const char *data() const { return s->data(); }
+		std::size_t size() const { return s->size(); }
+		bool empty() const { return s->empty(); }
+		std::string::const_iterator begin() const { return s->begin(); }
+		std::string::const_iterator end() const { return s->end(); }
+
+		friend bool operator==(const internedKey &a, const internedKey &b) { return a.s == b.s || *a.s == *b.s; }
+		friend bool operator!=(const internedKey &a, const internedKey &b) { return !(a == b); }
+		friend bool operator<(const internedKey &a, const internedKey &b) { return a.s != b.s && *a.s < *b.s; }
+		friend bool operator>(const internedKey &a, const internedKey &b) { return b < a; }
+		friend bool operator<=(const internedKey &a, const internedKey &b) { return !(b < a); }
+		friend bool operator>=(const internedKey &a, const internedKey &b) { return !(a < b); }
+
+		friend bool operator==(const internedKey &a, std::string_view b) { return std::string_view(*a.s) == b; }
+		friend bool operator==(std::string_view a, const internedKey &b) { return b == a; }
+		friend bool operator!=(const internedKey &a, std::string_view b) { return !(a == b); }
+		friend bool operator!=(std::string_view a, const internedKey &b) { return !(b == a); }
+		friend bool operator<(const internedKey &a, std::string_view b) { return std::string_view(*a.s) < b; }
+		friend bool operator<(std::string_view a, const internedKey &b) { return a < std::string_view(*b.s); }
+
+		friend std::ostream &operator<<(std::ostream &os, const internedKey &k) { return os << *k.s; }
+	};
+
+	// flatMap keyed by internedKey, in the shape basic_json's ObjectType parameter expects.
+	template <class Key, class T, class IgnoredLess = std::less<Key>,
+		class Allocator = std::allocator<std::pair<const Key, T> > >
+	using internedMap = flatMap<internedKey, T, std::less<internedKey>,
+		typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const internedKey, T> > >;
+
+	// basic_json whose object keys are interned: a document that repeats the same few keys
+	// thousands of times stores each distinct key once.
+	using internedJson = nlohmann::basic_json<internedMap>;
+
+	// parallelParse workers intern into a child of the calling thread's table, so a document parsed
+	// under its scope() owns every key in its tree and no worker takes a lock per key. With no
+	// table current the workers use keyTable::global(), as the calling thread does.
+	template <>
+	struct parseContext<internedJson> {
+		keyTable *table = keyTable::current();
+
+		struct worker {
+			std::optional<keyScope> scope;
+			explicit worker(parseContext &context) {
+				if (context.table) scope.emplace(context.table->child());
+			}
+		};
+	};
+
+	// Owns a key table and a single internedJson parsed with it, like arenaDocument does for arenas.
+	// Keys point into this document's table, so values taken out of root() must not outlive it;
+	// modify or parallelParse the tree under scope() so new keys land in the same table.
+	class internedDocument {
+		keyTable table;
+		internedJson rootValue;
+
+	public:
+		internedDocument() = default;
+		internedDocument(const internedDocument &) = delete;
+		internedDocument &operator=(const internedDocument &) = delete;
+
+		template <typename InputType>
+		internedJson &parse(InputType &&input) {
+			keyScope scope(table);
+			rootValue = internedJson::parse(std::forward<InputType>(input));
+			return rootValue;
+		}
+
+		template <typename IteratorType>
+		internedJson &parse(IteratorType first, IteratorType last) {
+			keyScope scope(table);
+			rootValue = internedJson::parse(first, last);
+			return rootValue;
+		}
+
+		keyScope scope() { return keyScope(table); }
+
+		internedJson &root() { return rootValue; }
+		const internedJson &root() const { return rootValue; }
+		// keys held, see keyTable::size()
+		std::size_t keys() const { return table.size(); }
+	};
+}
+
+#endif
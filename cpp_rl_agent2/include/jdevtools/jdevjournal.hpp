@@ -0,0 +1,162 @@
+#ifndef JDEVTOOLS_JDEVJOURNAL_HPP
+#define JDEVTOOLS_JDEVJOURNAL_HPP
+
+#include "jdevtools/jdevmmap.hpp"
+#include "nlohmann/json.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+
+namespace jdevtools {
+	// Checkpoints a document as a full snapshot plus an append-only log of RFC 6902 patches.
+	// Each log line is one batch (a JSON patch array); after compactAfter logged operations the
+	// current document is written back as the snapshot and the log starts over.
+	//
+	// update(path, value) only diffs the subtree at path, so callers that know what changed never
+	// walk the rest of the document. Anything changed but not reported is simply not journaled.
+	template <typename BasicJsonType = nlohmann::json>
+	class patchJournal {
+	public:
+		using pointer = typename BasicJsonType::json_pointer;
+
+	private:
+		std::string snapshotPath, logPath;
+		BasicJsonType doc;
+		BasicJsonType pending = BasicJsonType::array();
+		std::size_t batchOps, compactAfter;
+		std::size_t logged = 0;
+		std::ofstream log;
+
+		void record(const BasicJsonType &ops) {
+			if (ops.empty()) return;
+			doc.patch_inplace(ops);
+			for (const BasicJsonType &op : ops) pending.push_back(op);
+			if (pending.size() >= batchOps) flush();
+		}
+
+		// Replays whole lines only; a torn last line or a patch that no longer applies (log left
+		// over from an interrupted compaction) ends the replay.
+		bool replay() {
+			mappedFile file(logPath);
+			if (!file) return true;
+			const char *p = file.begin(), *end = file.end();
+			while (p < end) {
+				const char *eol = p;
+				while (eol < end && *eol != '\n') ++eol;
+				if (eol == end) return false;
+				BasicJsonType patch = BasicJsonType::parse(p, eol, nullptr, false);
+				if (patch.is_discarded()) return false;
+				try {
+					doc.patch_inplace(patch);
+				} catch (const typename BasicJsonType::exception &) {
+					return false;
+				}
+				logged += patch.size();
+				p = eol + 1;
+			}
+			return true;
+		}
+
+	public:
+		explicit patchJournal(std::size_t batchOps = 64, std::size_t compactAfter = 4096)
+			: batchOps(batchOps), compactAfter(compactAfter) {}
+		patchJournal(const patchJournal &) = delete;
+		patchJournal &operator=(const patchJournal &) = delete;
+		~patchJournal() {
+			try {
+				flush();
+			} catch (...) {
+			}
+		}
+
+		// Loads the snapshot and replays the log. Returns false if there is no snapshot yet;
+		// call reset() with the initial document in that case.
+		bool open(const std::string &snapshot, const std::string &logFile) {
+			snapshotPath = snapshot;
+			logPath = logFile;
+			pending = BasicJsonType::array();
+			logged = 0;
+			if (log.is_open()) log.close();
+
+			mappedFile file(snapshotPath);
+			if (!file) return false;
+			doc = BasicJsonType::parse(file.begin(), file.end());
+			if (!replay()) compact();
+			return true;
+		}
+
+		// Makes document the new snapshot and empties the log.
+		void reset(const BasicJsonType &document) {
+			doc = document;
+			pending = BasicJsonType::array();
+			compact();
+		}
+
+		const BasicJsonType &document() const { return doc; }
+
+		// Journals the difference between the current value at path and value.
+		void update(const pointer &path, const BasicJsonType &value) {
+			if (doc.contains(path)) {
+				record(BasicJsonType::diff(doc.at(path), value, path.to_string()));
+			} else {
+				BasicJsonType op;
+				op["op"] = "add";
+				op["path"] = path.to_string();
+				op["value"] = value;
+				record(BasicJsonType::array({ op }));
+			}
+		}
+
+		// Full diff against the whole document, for when the changed paths are unknown.
+		void update(const BasicJsonType &document) { record(BasicJsonType::diff(doc, document)); }
+
+		// Appends value to the array at path.
+		void append(const pointer &array, const BasicJsonType &value) {
+			BasicJsonType op;
+			op["op"] = "add";
+			op["path"] = array.to_string() + "/-";
+			op["value"] = value;
+			record(BasicJsonType::array({ op }));
+		}
+
+		// Writes the pending batch as one log line.
+		void flush() {
+			if (pending.empty() || logPath.empty()) return;
+			if (!log.is_open()) {
+				log.open(logPath, std::ios::binary | std::ios::app);
+				if (!log) throw std::runtime_error("patchJournal: cannot open " + logPath);
+			}
+			log << pending.dump() << '\n';
+			log.flush();
+			logged += pending.size();
+			pending = BasicJsonType::array();
+			if (compactAfter && logged >= compactAfter) compact();
+		}
+
+		// Folds everything journaled so far into a new snapshot and truncates the log.
+		void compact() {
+			if (snapshotPath.empty()) return;
+			const std::string tmp = snapshotPath + ".tmp";
+			{
+				std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+				file << std::setw(2) << doc;
+				if (!file) throw std::runtime_error("patchJournal: cannot write " + tmp);
+			}
+			if (std::rename(tmp.c_str(), snapshotPath.c_str()) != 0) {
+				std::remove(snapshotPath.c_str());
+				if (std::rename(tmp.c_str(), snapshotPath.c_str()) != 0)
+					throw std::runtime_error("patchJournal: cannot replace " + snapshotPath);
+			}
+			if (log.is_open()) log.close();
+			log.open(logPath, std::ios::binary | std::ios::trunc);
+			pending = BasicJsonType::array();
+			logged = 0;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef JDEVTOOLS_JDEVJSONPATH_HPP
+#define JDEVTOOLS_JDEVJSONPATH_HPP
+
+#include "jdevtools/jdevjsonview.hpp"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace jdevtools {
+	// One json_pointer reference token, split once: the key as the object's own key type and,
+	// when the token is a valid array index, that index. Lookups hand the key to find() as it is,
+	// so nothing is converted per call. With internedJson the key is interned in the table current
+	// when the token is built; build it under the document's scope() and keys compare by address.
+	template <typename BasicJsonType>
+	struct pathToken {
+		using key_type = typename BasicJsonType::object_t::key_type;
+
+		key_type key;
+		std::size_t index = 0;
+		bool isIndex = false;
+
+		static key_type makeKey(const std::string &token) {
+			if constexpr (std::is_constructible_v<key_type, const std::string &>) return key_type(token);
+			else return key_type(token.begin(), token.end());
+		}
+
+		explicit pathToken(const std::string &token) : key(makeKey(token)) {
+			isIndex = !token.empty() && token.size() < 20 && token.find_first_not_of("0123456789") == std::string::npos &&
+				(token.size() == 1 || token[0] != '0');
+			if (isIndex) index = std::stoull(token);
+		}
+
+		const BasicJsonType *step(const BasicJsonType &j) const {
+			if (j.is_object()) {
+				auto it = j.find(key);
+				return it != j.end() ? &*it : nullptr;
+			}
+			if (j.is_array() && isIndex && index < j.size()) return &j[index];
+			return nullptr;
+		}
+
+		std::optional<jsonView> step(jsonView v) const {
+			if (v.is_object()) {
+				for (auto it = v.begin(), e = v.end(); it != e; ++it)
+					if (it.key().string_equals(std::string_view(key.data(), key.size()))) return it.value();
+			} else if (v.is_array() && isIndex) {
+				std::size_t i = 0;
+				for (auto it = v.begin(), e = v.end(); it != e; ++it, ++i)
+					if (i == index) return *it;
+			}
+			return std::nullopt;
+		}
+	};
+
+	namespace pathDetail {
+		template <typename BasicJsonType>
+		std::vector<std::string> split(typename BasicJsonType::json_pointer ptr) {
+			std::vector<std::string> tokens;
+			for (; !ptr.empty(); ptr.pop_back()) tokens.push_back(ptr.back());
+			std::reverse(tokens.begin(), tokens.end());
+			return tokens;
+		}
+	}
+
+	// A json_pointer compiled once for repeated lookups: tokens are unescaped and array indices
+	// parsed up front, so resolving is one container lookup per level and nothing else.
+	template <typename BasicJsonType = nlohmann::json>
+	class compiledPath {
+		std::vector<pathToken<BasicJsonType> > tokens;
+		std::string text;
+
+	public:
+		explicit compiledPath(const typename BasicJsonType::json_pointer &ptr) : text(ptr.to_string()) {
+			for (const std::string &t : pathDetail::split<BasicJsonType>(ptr)) tokens.emplace_back(t);
+		}
+		explicit compiledPath(const std::string &pointer) : compiledPath(typename BasicJsonType::json_pointer(pointer)) {}
+
+		// nullptr if any level is missing or has the wrong type
+		const BasicJsonType *find(const BasicJsonType &j) const {
+			const BasicJsonType *at = &j;
+			for (const auto &t : tokens)
+				if (!(at = t.step(*at))) return nullptr;
+			return at;
+		}
+
+		std::optional<jsonView> find(jsonView v) const {
+			std::optional<jsonView> at = v;
+			for (const auto &t : tokens)
+				if (!(at = t.step(*at))) return std::nullopt;
+			return at;
+		}
+
+		const BasicJsonType &at(const BasicJsonType &j) const {
+			if (const BasicJsonType *found = find(j)) return *found;
+			throw std::out_of_range("compiledPath: " + text + " not found");
+		}
+
+		jsonView at(jsonView v) const {
+			if (std::optional<jsonView> found = find(v)) return *found;
+			throw std::out_of_range("compiledPath: " + text + " not found");
+		}
+
+		const std::string &to_string() const { return text; }
+	};
+
+	// Several paths merged into a trie, so extract() visits every shared prefix once and, on a
+	// jsonView, reads each object's members in a single pass whatever the number of paths below it.
+	// Missing paths come back as nullptr / nullopt; on duplicate keys the first one wins for views.
+	template <typename BasicJsonType = nlohmann::json>
+	class pathSet {
+		struct node {
+			std::optional<pathToken<BasicJsonType> > token; // empty for the root
+			std::vector<std::uint32_t> children;
+			std::vector<std::size_t> slots; // paths that end here
+		};
+
+		std::vector<node> nodes = std::vector<node>(1);
+		std::size_t paths = 0;
+
+		void walk(std::uint32_t n, const BasicJsonType &j, std::vector<const BasicJsonType *> &out) const {
+			for (std::size_t slot : nodes[n].slots) out[slot] = &j;
+			for (std::uint32_t c : nodes[n].children)
+				if (const BasicJsonType *next = nodes[c].token->step(j)) walk(c, *next, out);
+		}
+
+		void walk(std::uint32_t n, jsonView v, std::vector<std::optional<jsonView> > &out) const {
+			const node &here = nodes[n];
+			for (std::size_t slot : here.slots) out[slot] = v;
+			if (here.children.empty()) return;
+			const std::size_t count = here.children.size();
+			if (count == 1 || count > 64 || !v.is_object()) {
+				for (std::uint32_t c : here.children)
+					if (std::optional<jsonView> next = nodes[c].token->step(v)) walk(c, *next, out);
+				return;
+			}
+			// one pass over the members, matching each key against the children not found yet
+			std::uint64_t open = count == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << count) - 1;
+			for (auto it = v.begin(), e = v.end(); it != e && open; ++it) {
+				jsonView key = it.key();
+				std::string_view raw = key.get<std::string_view>();
+				bool escaped = raw.find('\\') != std::string_view::npos;
+				for (std::size_t k = 0; k < count; ++k) {
+					if (!(open >> k & 1)) continue;
+					std::uint32_t c = here.children[k];
+					const auto &name = nodes[c].token->key;
+					std::string_view want(name.data(), name.size());
+					if (escaped ? key.string_equals(want) : raw == want) {
+						open &= ~(std::uint64_t(1) << k);
+						walk(c, it.value(), out);
+						break;
+					}
+				}
+			}
+		}
+
+	public:
+		pathSet() = default;
+		pathSet(std::initializer_list<const char *> pointers) {
+			for (const char *p : pointers) add(typename BasicJsonType::json_pointer(p));
+		}
+
+		// Returns the slot the path's result is stored in.
+		std::size_t add(const typename BasicJsonType::json_pointer &ptr) {
+			std::uint32_t n = 0;
+			for (const std::string &t : pathDetail::split<BasicJsonType>(ptr)) {
+				std::uint32_t next = 0;
+				for (std::uint32_t c : nodes[n].children) {
+					const auto &key = nodes[c].token->key;
+					if (std::string_view(key.data(), key.size()) == t) next = c;
+				}
+				if (!next) {
+					next = static_cast<std::uint32_t>(nodes.size());
+					nodes.push_back(node());
+					nodes.back().token.emplace(t);
+					nodes[n].children.push_back(next);
+				}
+				n = next;
+			}
+			nodes[n].slots.push_back(paths);
+			return paths++;
+		}
+
+		std::size_t size() const { return paths; }
+
+		void extract(const BasicJsonType &j, std::vector<const BasicJsonType *> &out) const {
+			out.assign(paths, nullptr);
+			walk(0, j, out);
+		}
+
+		void extract(jsonView v, std::vector<std::optional<jsonView> > &out) const {
+			out.assign(paths, std::nullopt);
+			walk(0, v, out);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,482 @@
+#ifndef JDEVTOOLS_JDEVJSONVIEW_HPP
+#define JDEVTOOLS_JDEVJSONVIEW_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace jdevtools {
+	class jsonView;
+
+	// Structural index of a JSON text: one entry per value and per object key, in document order.
+	// Building it checks brackets, separators and string termination only; numbers, literals and
+	// escapes are checked when a value is actually read. The text must outlive the index.
+	class jsonIndex {
+		friend class jsonView;
+
+		struct node {
+			std::uint32_t offset; // first byte of the token
+			std::uint32_t length; // bytes up to and including the closing quote or bracket
+			std::uint32_t next;   // index of the entry after this value and all of its children
+		};
+
+		std::string_view text;
+		std::vector<node> tape;
+		std::vector<std::uint32_t> open; // containers still open while building
+
+		[[noreturn]] void fail(const char *what, std::size_t at) const {
+			throw std::runtime_error(std::string("jsonIndex: ") + what + " at byte " + std::to_string(at));
+		}
+
+		std::size_t skipWhitespace(std::size_t i) const {
+			std::size_t newlines = 0, lastNewline = 0;
+			return i + nlohmann::detail::whitespace_run_length(text.data() + i, text.size() - i, newlines, lastNewline);
+		}
+
+		// i points at the opening quote; returns the index after the closing quote
+		std::size_t skipString(std::size_t i) const {
+			const char *p = text.data();
+			const std::size_t n = text.size();
+			for (++i; i < n;) {
+				i += nlohmann::detail::plain_string_run_length(p + i, n - i);
+				if (i >= n) break;
+				if (p[i] == '"') return i + 1;
+				i += p[i] == '\\' ? 2 : 1;
+			}
+			fail("missing closing quote", n);
+		}
+
+		std::size_t skipScalar(std::size_t i) const {
+			const char *p = text.data();
+			std::size_t j = i;
+			while (j < text.size() && p[j] != ',' && p[j] != ']' && p[j] != '}' && p[j] != ' ' && p[j] != '\t' &&
+				p[j] != '\n' && p[j] != '\r')
+				j++;
+			return j;
+		}
+
+		std::uint32_t push(std::size_t offset, std::size_t length) {
+			tape.push_back({std::uint32_t(offset), std::uint32_t(length), std::uint32_t(tape.size() + 1)});
+			return std::uint32_t(tape.size() - 1);
+		}
+
+		void build() {
+			if (text.size() >= UINT32_MAX) fail("input too large", 0);
+			enum class expect { value, key, colon, separator };
+			tape.clear();
+			open.clear();
+			expect state = expect::value;
+			const char *p = text.data();
+			std::size_t i = skipWhitespace(0);
+
+			while (true) {
+				if (i >= text.size()) {
+					if (open.empty() && state == expect::separator) return;
+					fail("unexpected end of input", i);
+				}
+				const char c = p[i];
+				switch (state) {
+				case expect::value:
+					if (c == '{' || c == '[') {
+						open.push_back(push(i, 0));
+						i = skipWhitespace(i + 1);
+						if (i < text.size() && p[i] == (c == '{' ? '}' : ']')) {
+							state = expect::separator;
+							continue;
+						}
+						state = c == '{' ? expect::key : expect::value;
+						continue;
+					}
+					if (c == '"') {
+						std::size_t end = skipString(i);
+						push(i, end - i);
+						i = end;
+					} else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+						std::size_t end = skipScalar(i);
+						push(i, end - i);
+						i = end;
+					} else {
+						fail("unexpected character", i);
+					}
+					state = expect::separator;
+					if (open.empty()) {
+						i = skipWhitespace(i);
+						if (i != text.size()) fail("trailing characters", i);
+						return;
+					}
+					break;
+
+				case expect::key:
+					if (c != '"') fail("expected object key", i);
+					{
+						std::size_t end = skipString(i);
+						push(i, end - i);
+						i = end;
+					}
+					state = expect::colon;
+					break;
+
+				case expect::colon:
+					if (c != ':') fail("expected ':'", i);
+					i++;
+					state = expect::value;
+					break;
+
+				case expect::separator:
+					if (open.empty()) fail("trailing characters", i);
+					{
+						node &container = tape[open.back()];
+						const char close = p[container.offset] == '{' ? '}' : ']';
+						if (c == ',') {
+							i++;
+							state = close == '}' ? expect::key : expect::value;
+						} else if (c == close) {
+							container.length = std::uint32_t(i + 1 - container.offset);
+							container.next = std::uint32_t(tape.size());
+							open.pop_back();
+							i++;
+							if (open.empty()) {
+								i = skipWhitespace(i);
+								if (i != text.size()) fail("trailing characters", i);
+								return;
+							}
+						} else {
+							fail("expected ',' or closing bracket", i);
+						}
+					}
+					break;
+				}
+				i = skipWhitespace(i);
+			}
+		}
+
+	public:
+		jsonIndex() = default;
+		explicit jsonIndex(std::string_view json) { parse(json); }
+		jsonIndex(std::string &&) = delete; // the index does not own its text
+
+		// Re-indexes a new text, reusing the storage of the previous one, so an index kept across
+		// responses of similar size stops allocating after the first few. Views into the old
+		// text are invalidated.
+		void parse(std::string_view json) {
+			text = json;
+			tape.reserve(json.size() / 8 + 1);
+			try {
+				build();
+			} catch (...) {
+				tape.clear();
+				text = std::string_view();
+				throw;
+			}
+		}
+		void parse(std::string &&) = delete;
+
+		// true until a parse succeeds; root() needs a parsed text
+		bool empty() const { return tape.empty(); }
+		jsonView root() const;
+		std::size_t nodes() const { return tape.size(); }
+	};
+
+	// Read-only handle to one value of a jsonIndex. Navigating never allocates;
+	// strings are unescaped and numbers converted only when get<T>() is called.
+	class jsonView {
+		friend class jsonIndex;
+
+		const jsonIndex *doc = nullptr;
+		std::uint32_t at = 0;
+
+		jsonView(const jsonIndex *d, std::uint32_t i) : doc(d), at(i) {}
+
+		const jsonIndex::node &self() const { return doc->tape[at]; }
+		char first() const { return doc->text[self().offset]; }
+
+		const char *typeName() const {
+			switch (first()) {
+			case '{': return "object";
+			case '[': return "array";
+			case '"': return "string";
+			case 't':
+			case 'f': return "boolean";
+			case 'n': return "null";
+			default: return "number";
+			}
+		}
+
+		// the same exceptions basic_json throws for a value of the wrong type or a number it cannot hold
+		[[noreturn]] void typeError(const char *expected) const {
+			throw nlohmann::detail::type_error::create(302, std::string("type must be ") + expected + ", but is " + typeName(), nullptr);
+		}
+
+		[[noreturn]] void overflow(const char *doing) const {
+			throw nlohmann::detail::out_of_range::create(406, std::string("number overflow ") + doing + " '" + std::string(raw()) + "'", nullptr);
+		}
+
+		// contents of a string token without the quotes, escapes untouched
+		std::string_view quoted() const {
+			std::string_view r = raw();
+			return r.substr(1, r.size() - 2);
+		}
+
+		static unsigned hex4(std::string_view s, std::size_t i) {
+			if (i + 4 > s.size()) throw std::runtime_error("jsonView: truncated \\u escape");
+			unsigned v = 0;
+			for (std::size_t k = i; k < i + 4; k++) {
+				char c = s[k];
+				v <<= 4;
+				if (c >= '0' && c <= '9') v |= unsigned(c - '0');
+				else if (c >= 'a' && c <= 'f') v |= unsigned(c - 'a' + 10);
+				else if (c >= 'A' && c <= 'F') v |= unsigned(c - 'A' + 10);
+				else throw std::runtime_error("jsonView: invalid \\u escape");
+			}
+			return v;
+		}
+
+		static void appendUtf8(std::string &out, unsigned cp) {
+			if (cp < 0x80) {
+				out += char(cp);
+			} else if (cp < 0x800) {
+				out += char(0xC0 | (cp >> 6));
+				out += char(0x80 | (cp & 0x3F));
+			} else if (cp < 0x10000) {
+				out += char(0xE0 | (cp >> 12));
+				out += char(0x80 | ((cp >> 6) & 0x3F));
+				out += char(0x80 | (cp & 0x3F));
+			} else {
+				out += char(0xF0 | (cp >> 18));
+				out += char(0x80 | ((cp >> 12) & 0x3F));
+				out += char(0x80 | ((cp >> 6) & 0x3F));
+				out += char(0x80 | (cp & 0x3F));
+			}
+		}
+
+		static void unescape(std::string_view s, std::string &out) {
+			out.reserve(out.size() + s.size());
+			for (std::size_t i = 0; i < s.size(); i++) {
+				if (s[i] != '\\') {
+					out += s[i];
+					continue;
+				}
+				if (++i >= s.size()) throw std::runtime_error("jsonView: truncated escape");
+				switch (s[i]) {
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u': {
+					unsigned cp = hex4(s, i + 1);
+					i += 4;
+					// surrogates only come in high-low pairs, as basic_json::parse requires
+					if (cp >= 0xDC00 && cp <= 0xDFFF) throw std::runtime_error("jsonView: invalid surrogate");
+					if (cp >= 0xD800 && cp <= 0xDBFF) {
+						if (i + 6 >= s.size() || s.substr(i + 1, 2) != "\\u") throw std::runtime_error("jsonView: invalid surrogate");
+						unsigned low = hex4(s, i + 3);
+						if (low < 0xDC00 || low > 0xDFFF) throw std::runtime_error("jsonView: invalid surrogate");
+						cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+						i += 6;
+					}
+					appendUtf8(out, cp);
+					break;
+				}
+				default: throw std::runtime_error("jsonView: invalid escape");
+				}
+			}
+		}
+
+		// true if the key token at tape index k equals key
+		bool keyEquals(std::uint32_t k, std::string_view key) const { return jsonView(doc, k).string_equals(key); }
+
+		// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, which is narrower than what from_chars and
+		// strtod take (no inf, nan, hex or leading zeros)
+		static bool validNumber(std::string_view s) {
+			std::size_t i = 0;
+			auto digits = [&] {
+				std::size_t from = i;
+				while (i < s.size() && s[i] >= '0' && s[i] <= '9') i++;
+				return i > from;
+			};
+			if (i < s.size() && s[i] == '-') i++;
+			if (i < s.size() && s[i] == '0') i++;
+			else if (!digits()) return false;
+			if (i < s.size() && s[i] == '.') {
+				i++;
+				if (!digits()) return false;
+			}
+			if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+				i++;
+				if (i < s.size() && (s[i] == '+' || s[i] == '-')) i++;
+				if (!digits()) return false;
+			}
+			return i == s.size();
+		}
+
+		// text of a number value, rejected the way basic_json's parser would reject it
+		std::string_view numberText() const {
+			if (!is_number()) typeError("number");
+			std::string_view r = raw();
+			if (!validNumber(r))
+				throw nlohmann::detail::parse_error::create(101, std::size_t(self().offset) + 1,
+					"syntax error while parsing value - invalid number; last read: '" + std::string(r) + "'", nullptr);
+			return r;
+		}
+
+		double toDouble() const {
+			std::string_view r = numberText();
+			double v = 0;
+#if JSON_HAS_FLOAT_FROM_CHARS
+			auto res = std::from_chars(r.data(), r.data() + r.size(), v);
+			if (res.ec == std::errc()) return v;
+#endif
+			// out of range for from_chars: strtod tells underflow (kept, as basic_json keeps it) from overflow
+			std::string tmp(r);
+			v = std::strtod(tmp.c_str(), nullptr);
+			if (std::isinf(v)) overflow("parsing");
+			return v;
+		}
+
+		// truncates like basic_json's static_cast, but refuses values T cannot hold
+		template <typename T>
+		T narrow(double v) const {
+			if constexpr (std::is_integral_v<T>) {
+				double t = std::trunc(v);
+				if (t >= double(std::numeric_limits<T>::min()) && t < double(std::numeric_limits<T>::max()) + 1.0)
+					return static_cast<T>(t);
+			} else {
+				if (std::fabs(v) <= double(std::numeric_limits<T>::max())) return static_cast<T>(v);
+			}
+			overflow("converting");
+		}
+
+	public:
+		class iterator {
+			friend class jsonView;
+			const jsonIndex *doc;
+			std::uint32_t at;   // current value (or key, for objects)
+			bool object;
+
+			iterator(const jsonIndex *d, std::uint32_t i, bool obj) : doc(d), at(i), object(obj) {}
+			std::uint32_t valueIndex() const { return object ? at + 1 : at; }
+
+		public:
+			jsonView operator*() const { return jsonView(doc, valueIndex()); }
+			// key of the current member (objects only)
+			jsonView key() const { return jsonView(doc, at); }
+			jsonView value() const { return **this; }
+			iterator &operator++() {
+				at = doc->tape[valueIndex()].next;
+				return *this;
+			}
+			bool operator==(const iterator &o) const { return at == o.at; }
+			bool operator!=(const iterator &o) const { return at != o.at; }
+		};
+
+		jsonView() = default;
+
+		bool is_object() const { return first() == '{'; }
+		bool is_array() const { return first() == '['; }
+		bool is_string() const { return first() == '"'; }
+		bool is_boolean() const { return raw() == "true" || raw() == "false"; }
+		bool is_null() const { return raw() == "null"; }
+		bool is_number() const { return first() == '-' || (first() >= '0' && first() <= '9'); }
+
+		// text of the value exactly as it appears in the input
+		std::string_view raw() const { return doc->text.substr(self().offset, self().length); }
+
+		iterator begin() const {
+			if (!is_object() && !is_array()) typeError("array or object");
+			return iterator(doc, at + 1, is_object());
+		}
+		iterator end() const { return iterator(doc, self().next, is_object()); }
+
+		std::size_t size() const {
+			std::size_t n = 0;
+			for (iterator it = begin(), e = end(); it != e; ++it) n++;
+			return n;
+		}
+
+		bool contains(std::string_view key) const {
+			if (!is_object()) return false;
+			for (iterator it = begin(), e = end(); it != e; ++it)
+				if (keyEquals(it.at, key)) return true;
+			return false;
+		}
+
+		jsonView operator[](std::string_view key) const {
+			if (!is_object()) typeError("object");
+			for (iterator it = begin(), e = end(); it != e; ++it)
+				if (keyEquals(it.at, key)) return *it;
+			throw std::out_of_range("jsonView: key '" + std::string(key) + "' not found");
+		}
+
+		jsonView operator[](std::size_t index) const {
+			if (!is_array()) typeError("array");
+			iterator it = begin(), e = end();
+			for (std::size_t i = 0; i < index && it != e; i++) ++it;
+			if (it == e) throw std::out_of_range("jsonView: index " + std::to_string(index) + " out of range");
+			return *it;
+		}
+
+		// compares a string (or object key) with s after unescaping, without allocating when it has no escapes
+		bool string_equals(std::string_view s) const {
+			if (!is_string()) return false;
+			std::string_view q = quoted();
+			if (q.find('\\') == std::string_view::npos) return q == s;
+			std::string tmp;
+			unescape(q, tmp);
+			return tmp == s;
+		}
+
+		template <typename T>
+		T get() const {
+			if constexpr (std::is_same_v<T, bool>) {
+				if (raw() == "true") return true;
+				if (raw() == "false") return false;
+				typeError("boolean");
+			} else if constexpr (std::is_integral_v<T>) {
+				std::string_view r = numberText();
+				T v{};
+				auto res = std::from_chars(r.data(), r.data() + r.size(), v);
+				if (res.ec == std::errc() && res.ptr == r.data() + r.size()) return v;
+				// fractions and exponents truncate like basic_json does; values T cannot hold throw
+				return narrow<T>(toDouble());
+			} else if constexpr (std::is_floating_point_v<T>) {
+				return narrow<T>(toDouble());
+			} else if constexpr (std::is_same_v<T, std::string>) {
+				if (!is_string()) typeError("string");
+				std::string out;
+				unescape(quoted(), out);
+				return out;
+			} else if constexpr (std::is_same_v<T, std::string_view>) {
+				// raw contents, only meaningful for strings without escapes
+				if (!is_string()) typeError("string");
+				return quoted();
+			} else {
+				static_assert(!sizeof(T), "jsonView::get: unsupported type");
+			}
+		}
+
+		// build a regular DOM of this value, for code that needs the full basic_json API
+		template <typename BasicJsonType = nlohmann::json>
+		BasicJsonType materialize() const {
+			std::string_view r = raw();
+			return BasicJsonType::parse(r.data(), r.data() + r.size());
+		}
+	};
+
+	inline jsonView jsonIndex::root() const { return jsonView(this, 0); }
+}
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef JDEVTOOLS_JDEVJSONWRITER_HPP
+#define JDEVTOOLS_JDEVJSONWRITER_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jdevtools {
+	class jsonWriter;
+
+	// write(jsonWriter&, const T&) is the customization point used by jsonWriter::value().
+	// Overloads for your own types are found by ADL, so declare them next to the type.
+	inline void write(jsonWriter &w, std::nullptr_t);
+	inline void write(jsonWriter &w, bool b);
+	inline void write(jsonWriter &w, std::string_view s);
+	inline void write(jsonWriter &w, const char *s);
+	inline void write(jsonWriter &w, const std::string &s);
+	template <typename T>
+	std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value> write(jsonWriter &w, T v);
+	template <typename T>
+	std::enable_if_t<std::is_floating_point<T>::value> write(jsonWriter &w, T v);
+	template <typename A, typename B>
+	void write(jsonWriter &w, const std::pair<A, B> &p);
+	template <typename R>
+	auto write(jsonWriter &w, const R &range) -> decltype(std::begin(range), std::end(range),
+		std::enable_if_t<!std::is_convertible<const R &, std::string_view>::value &&
+			!nlohmann::detail::is_basic_json<R>::value>());
+	template <typename BasicJsonType>
+	std::enable_if_t<nlohmann::detail::is_basic_json<BasicJsonType>::value> write(jsonWriter &w, const BasicJsonType &j);
+
+	// Streams JSON text straight into an nlohmann output adapter (std::string, std::vector<char>
+	// or std::ostream) without building a DOM. Output is buffered internally and has the same
+	// layout as basic_json::dump(indent): indent < 0 is compact, otherwise pretty-printed.
+	// Strings are escaped like dump() does, but bytes >= 0x80 are copied without UTF-8 validation.
+	class jsonWriter {
+		// Buffered sink; it is also handed to nlohmann's serializer when a basic_json is written.
+		class bufferedOutput : public nlohmann::detail::output_adapter_protocol<char> {
+			nlohmann::detail::output_adapter_t<char> target;
+			std::vector<char> buffer;
+			std::size_t used = 0;
+
+		public:
+			bufferedOutput(nlohmann::detail::output_adapter_t<char> out, std::size_t capacity)
+				: target(std::move(out)), buffer(capacity) {}
+
+			void write_character(char c) override {
+				if (used == buffer.size()) flush();
+				buffer[used++] = c;
+			}
+
+			void write_characters(const char *s, std::size_t length) override {
+				if (length > buffer.size() - used) {
+					flush();
+					if (length >= buffer.size()) {
+						target->write_characters(s, length);
+						return;
+					}
+				}
+				std::char_traits<char>::copy(buffer.data() + used, s, length);
+				used += length;
+			}
+
+			void flush() {
+				if (used) target->write_characters(buffer.data(), used);
+				used = 0;
+			}
+		};
+
+		struct level {
+			bool array;
+			bool empty;
+		};
+
+		std::shared_ptr<bufferedOutput> out;
+		int indentStep;
+		char indentChar;
+		std::string indentString;
+		std::vector<level> levels;
+		bool afterKey = false;
+
+		void newline() {
+			if (indentStep < 0) return;
+			std::size_t width = levels.size() * static_cast<std::size_t>(indentStep);
+			if (indentString.size() < width) indentString.resize(width * 2, indentChar);
+			out->write_character('\n');
+			out->write_characters(indentString.data(), width);
+		}
+
+		void beforeValue() {
+			if (afterKey) {
+				afterKey = false;
+				return;
+			}
+			if (levels.empty()) return;
+			level &l = levels.back();
+			if (!l.array) throw std::runtime_error("jsonWriter: value inside an object needs a key first");
+			if (!l.empty) out->write_character(',');
+			l.empty = false;
+			newline();
+		}
+
+		void close(bool array, char bracket) {
+			if (levels.empty() || levels.back().array != array || afterKey)
+				throw std::runtime_error(std::string("jsonWriter: unbalanced ") + bracket);
+			bool empty = levels.back().empty;
+			levels.pop_back();
+			if (!empty) newline();
+			out->write_character(bracket);
+		}
+
+		void quoted(std::string_view s) {
+			static const char hex[] = "0123456789abcdef";
+			const char *p = s.data();
+			const std::size_t n = s.size();
+			out->write_character('"');
+			for (std::size_t i = 0; i < n;) {
+				std::size_t run = nlohmann::detail::plain_string_run_length(p + i, n - i);
+				out->write_characters(p + i, run);
+				i += run;
+				if (i >= n) break;
+				unsigned char c = static_cast<unsigned char>(p[i++]);
+				switch (c) {
+					case '"': out->write_characters("\\\"", 2); break;
+					case '\\': out->write_characters("\\\\", 2); break;
+					case '\b': out->write_characters("\\b", 2); break;
+					case '\f': out->write_characters("\\f", 2); break;
+					case '\n': out->write_characters("\\n", 2); break;
+					case '\r': out->write_characters("\\r", 2); break;
+					case '\t': out->write_characters("\\t", 2); break;
+					default:
+						if (c < 0x20) {
+							const char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+							out->write_characters(esc, 6);
+						} else {
+							out->write_character(static_cast<char>(c));
+						}
+				}
+			}
+			out->write_character('"');
+		}
+
+	public:
+		explicit jsonWriter(nlohmann::detail::output_adapter<char> target, int indent = -1, char indentChar = ' ',
+			std::size_t bufferSize = 16 * 1024)
+			: out(std::make_shared<bufferedOutput>(target, bufferSize)), indentStep(indent), indentChar(indentChar),
+			indentString(indent > 0 ? 16 * static_cast<std::size_t>(indent) : 0, indentChar) {}
+		jsonWriter(const jsonWriter &) = delete;
+		jsonWriter &operator=(const jsonWriter &) = delete;
+		~jsonWriter() {
+			try {
+				out->flush();
+			} catch (...) {
+			}
+		}
+
+		jsonWriter &begin_object() {
+			beforeValue();
+			out->write_character('{');
+			levels.push_back({ false, true });
+			return *this;
+		}
+		jsonWriter &end_object() {
+			close(false, '}');
+			return *this;
+		}
+
+		jsonWriter &begin_array() {
+			beforeValue();
+			out->write_character('[');
+			levels.push_back({ true, true });
+			return *this;
+		}
+		jsonWriter &end_array() {
+			close(true, ']');
+			return *this;
+		}
+
+		jsonWriter &key(std::string_view k) {
+			if (levels.empty() || levels.back().array || afterKey)
+				throw std::runtime_error("jsonWriter: key outside of an object");
+			level &l = levels.back();
+			if (!l.empty) out->write_character(',');
+			l.empty = false;
+			newline();
+			quoted(k);
+			if (indentStep >= 0) out->write_characters(": ", 2);
+			else out->write_character(':');
+			afterKey = true;
+			return *this;
+		}
+
+		// Writes any value that has a write(jsonWriter&, const T&) overload.
+		template <typename T>
+		jsonWriter &value(const T &v);
+
+		jsonWriter &null() {
+			beforeValue();
+			out->write_characters("null", 4);
+			return *this;
+		}
+
+		jsonWriter &boolean(bool b) {
+			beforeValue();
+			if (b) out->write_characters("true", 4);
+			else out->write_characters("false", 5);
+			return *this;
+		}
+
+		template <typename T>
+		std::enable_if_t<std::is_integral<T>::value, jsonWriter &> integer(T v) {
+			using U = std::make_unsigned_t<T>;
+			char buf[24];
+			char *end = buf + sizeof buf;
+			char *p = end;
+			U u = static_cast<U>(v);
+			bool negative = false;
+			if constexpr (std::is_signed<T>::value) {
+				if (v < 0) {
+					negative = true;
+					u = static_cast<U>(U(0) - u);
+				}
+			}
+			do {
+				*--p = static_cast<char>('0' + u % 10);
+				u /= 10;
+			} while (u);
+			if (negative) *--p = '-';
+			beforeValue();
+			out->write_characters(p, static_cast<std::size_t>(end - p));
+			return *this;
+		}
+
+		// Same text as dump(): shortest round-trip digits, NaN and infinities become null.
+		jsonWriter &number(double v) {
+			if (!std::isfinite(v)) return null();
+			char buf[64];
+			char *end = nlohmann::detail::to_chars(buf, buf + sizeof buf, v);
+			beforeValue();
+			out->write_characters(buf, static_cast<std::size_t>(end - buf));
+			return *this;
+		}
+
+		jsonWriter &string(std::string_view s) {
+			beforeValue();
+			quoted(s);
+			return *this;
+		}
+
+		// Serializes a DOM value in place, indented to the current depth.
+		template <typename BasicJsonType>
+		jsonWriter &json(const BasicJsonType &j) {
+			beforeValue();
+			nlohmann::detail::serializer<BasicJsonType> s(out, indentChar);
+			s.dump(j, indentStep >= 0, false, indentStep >= 0 ? static_cast<unsigned int>(indentStep) : 0,
+				static_cast<unsigned int>(levels.size() * static_cast<std::size_t>(indentStep >= 0 ? indentStep : 0)));
+			return *this;
+		}
+
+		// Pushes buffered text to the target; the destructor does this too.
+		void flush() { out->flush(); }
+	};
+
+	inline void write(jsonWriter &w, std::nullptr_t) { w.null(); }
+	inline void write(jsonWriter &w, bool b) { w.boolean(b); }
+	inline void write(jsonWriter &w, std::string_view s) { w.string(s); }
+	inline void write(jsonWriter &w, const char *s) { w.string(s); }
+	inline void write(jsonWriter &w, const std::string &s) { w.string(s); }
+
+	// char is written as a number, the same as basic_json stores it.
+	template <typename T>
+	std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value> write(jsonWriter &w, T v) {
+		w.integer(v);
+	}
+
+	template <typename T>
+	std::enable_if_t<std::is_floating_point<T>::value> write(jsonWriter &w, T v) {
+		w.number(static_cast<double>(v));
+	}
+
+	template <typename A, typename B>
+	void write(jsonWriter &w, const std::pair<A, B> &p) {
+		w.begin_array();
+		w.value(p.first);
+		w.value(p.second);
+		w.end_array();
+	}
+
+	namespace writerDetail {
+		template <typename T, typename = void>
+		struct isStringMap : std::false_type {};
+		template <typename T>
+		struct isStringMap<T, std::void_t<typename T::key_type, typename T::mapped_type> >
+			: std::is_convertible<const typename T::key_type &, std::string_view> {};
+	}
+
+	// Containers become arrays; containers keyed by strings become objects.
+	template <typename R>
+	auto write(jsonWriter &w, const R &range) -> decltype(std::begin(range), std::end(range),
+		std::enable_if_t<!std::is_convertible<const R &, std::string_view>::value &&
+			!nlohmann::detail::is_basic_json<R>::value>()) {
+		if constexpr (writerDetail::isStringMap<R>::value) {
+			w.begin_object();
+			for (const auto &item : range) w.key(item.first).value(item.second);
+			w.end_object();
+		} else {
+			w.begin_array();
+			for (const auto &item : range) w.value(item);
+			w.end_array();
+		}
+	}
+
+	template <typename BasicJsonType>
+	std::enable_if_t<nlohmann::detail::is_basic_json<BasicJsonType>::value> write(jsonWriter &w, const BasicJsonType &j) {
+		w.json(j);
+	}
+
+	template <typename T>
+	jsonWriter &jsonWriter::value(const T &v) {
+		write(*this, v);
+		return *this;
+	}
+}
+
+#endif
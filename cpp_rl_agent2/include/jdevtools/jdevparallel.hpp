@@ -0,0 +1,265 @@
+#ifndef JDEVTOOLS_JDEVPARALLEL_HPP
+#define JDEVTOOLS_JDEVPARALLEL_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jdevtools {
+	// Finds the elements of one array inside a JSON text without parsing it: only strings and
+	// bracket depth are tracked. Anything it does not understand makes locate() return false,
+	// and the caller falls back to an ordinary parse, which then reports the real error.
+	class arraySplitter {
+		std::string_view text;
+
+		std::size_t skipWhitespace(std::size_t i) const {
+			std::size_t newlines = 0, lastNewline = 0;
+			return i + nlohmann::detail::whitespace_run_length(text.data() + i, text.size() - i, newlines, lastNewline);
+		}
+
+		// i is at the opening quote; returns the index after the closing one, or npos
+		std::size_t skipString(std::size_t i) const {
+			const char *p = text.data();
+			const std::size_t n = text.size();
+			for (++i; i < n;) {
+				i += nlohmann::detail::plain_string_run_length(p + i, n - i);
+				if (i >= n) break;
+				if (p[i] == '"') return i + 1;
+				i += p[i] == '\\' ? 2 : 1;
+			}
+			return std::string_view::npos;
+		}
+
+		std::size_t skipValue(std::size_t i) const {
+			const char *p = text.data();
+			const std::size_t n = text.size();
+			if (i >= n) return std::string_view::npos;
+			if (p[i] == '"') return skipString(i);
+			if (p[i] == '[' || p[i] == '{') {
+				std::size_t depth = 0;
+				while (i < n) {
+					char c = p[i];
+					if (c == '"') {
+						i = skipString(i);
+						if (i == std::string_view::npos) return i;
+						continue;
+					}
+					if (c == '[' || c == '{') ++depth;
+					else if (c == ']' || c == '}') {
+						if (--depth == 0) return i + 1;
+					}
+					++i;
+				}
+				return std::string_view::npos;
+			}
+			std::size_t j = i;
+			while (j < n && p[j] != ',' && p[j] != ']' && p[j] != '}' && p[j] != ' ' && p[j] != '\t' && p[j] != '\n' &&
+				p[j] != '\r')
+				++j;
+			return j > i ? j : std::string_view::npos;
+		}
+
+		// Moves i from a container's first byte to the member/element named by token.
+		// Objects resolve to the last matching key, as basic_json does on duplicates.
+		bool step(std::size_t &i, const std::string &token) const {
+			const char *p = text.data();
+			const std::size_t n = text.size();
+			bool object = p[i] == '{';
+			std::size_t want = 0;
+			if (!object) {
+				if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos) return false;
+				want = std::stoul(token);
+			}
+			std::size_t found = std::string_view::npos;
+			i = skipWhitespace(i + 1);
+			if (i < n && p[i] == (object ? '}' : ']')) return false;
+			for (std::size_t index = 0;; ++index) {
+				if (object) {
+					if (i >= n || p[i] != '"') return false;
+					std::size_t end = skipString(i);
+					if (end == std::string_view::npos) return false;
+					std::string_view key = text.substr(i + 1, end - i - 2);
+					// escaped keys would need unescaping to compare
+					if (key.find('\\') != std::string_view::npos) return false;
+					i = skipWhitespace(end);
+					if (i >= n || p[i] != ':') return false;
+					i = skipWhitespace(i + 1);
+					if (key == token) found = i;
+				} else if (index == want) {
+					return true;
+				}
+				i = skipValue(i);
+				if (i == std::string_view::npos) return false;
+				i = skipWhitespace(i);
+				if (i >= n) return false;
+				if (p[i] == ',') {
+					i = skipWhitespace(i + 1);
+					continue;
+				}
+				if (p[i] != (object ? '}' : ']')) return false;
+				break;
+			}
+			if (found == std::string_view::npos) return false;
+			i = found;
+			return true;
+		}
+
+	public:
+		struct element {
+			std::size_t begin, end;
+		};
+
+		std::size_t arrayBegin = 0, arrayEnd = 0; // the brackets, arrayEnd one past ']'
+		std::vector<element> elements;
+
+		explicit arraySplitter(std::string_view json) : text(json) {}
+
+		bool locate(const std::vector<std::string> &path) {
+			const char *p = text.data();
+			const std::size_t n = text.size();
+			std::size_t i = skipWhitespace(0);
+			for (const std::string &token : path) {
+				if (i >= n || (p[i] != '{' && p[i] != '[')) return false;
+				if (!step(i, token)) return false;
+			}
+			if (i >= n || p[i] != '[') return false;
+			arrayBegin = i;
+			elements.clear();
+			i = skipWhitespace(i + 1);
+			if (i < n && p[i] == ']') {
+				arrayEnd = i + 1;
+				return true;
+			}
+			while (i < n) {
+				std::size_t end = skipValue(i);
+				if (end == std::string_view::npos) return false;
+				elements.push_back({ i, end });
+				i = skipWhitespace(end);
+				if (i >= n) return false;
+				if (p[i] == ']') {
+					arrayEnd = i + 1;
+					return true;
+				}
+				if (p[i] != ',') return false;
+				i = skipWhitespace(i + 1);
+			}
+			return false;
+		}
+	};
+
+	// Thread-local state that parallelParse workers share with the calling thread. The context is
+	// built on the calling thread before any worker starts, and each piece is parsed while a
+	// worker made from it is alive. The default carries nothing; a json type whose parsing depends
+	// on thread-local state specializes it (see internedJson).
+	template <typename BasicJsonType>
+	struct parseContext {
+		struct worker {
+			explicit worker(parseContext &) {}
+		};
+	};
+
+	// Parses a contiguous JSON text, splitting the array at arrayPath (the whole document by
+	// default) across threads: each thread parses a run of elements, the rest of the document is
+	// parsed with that array left empty, and the parsed elements are moved into place afterwards.
+	// Inputs below minBytes, or any input the pre-pass cannot split, take the serial path; if a
+	// piece fails to parse, the whole text is parsed serially so errors match basic_json::parse.
+	template <typename BasicJsonType = nlohmann::json>
+	BasicJsonType parallelParse(std::string_view text,
+		const typename BasicJsonType::json_pointer &arrayPath = typename BasicJsonType::json_pointer(),
+		unsigned threads = 0, std::size_t minBytes = 256 * 1024) {
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		if (threads == 1 || text.size() < minBytes) return BasicJsonType::parse(text.data(), text.data() + text.size());
+
+		std::vector<std::string> path;
+		for (auto ptr = arrayPath; !ptr.empty(); ptr.pop_back()) path.push_back(ptr.back());
+		std::reverse(path.begin(), path.end());
+
+		arraySplitter split(text);
+		if (!split.locate(path) || split.elements.size() < 2)
+			return BasicJsonType::parse(text.data(), text.data() + text.size());
+
+		// runs of elements with roughly equal byte counts
+		const std::size_t arrayBytes = split.arrayEnd - split.arrayBegin;
+		const std::size_t chunks = std::min<std::size_t>(threads, split.elements.size());
+		std::vector<std::pair<std::size_t, std::size_t> > runs;
+		std::size_t first = 0;
+		for (std::size_t e = 0; e < split.elements.size(); ++e) {
+			std::size_t done = split.elements[e].end - split.arrayBegin;
+			bool last = e + 1 == split.elements.size();
+			if (last || done * chunks >= arrayBytes * (runs.size() + 1)) {
+				runs.push_back({ first, e + 1 });
+				first = e + 1;
+			}
+		}
+
+		std::vector<BasicJsonType> parsed(runs.size());
+		std::vector<char> failed(runs.size(), 0);
+		parseContext<BasicJsonType> context;
+		auto parseRun = [&](std::size_t r) {
+			try {
+				typename parseContext<BasicJsonType>::worker state(context);
+				std::size_t from = split.elements[runs[r].first].begin;
+				std::size_t to = split.elements[runs[r].second - 1].end;
+				std::string piece;
+				piece.reserve(to - from + 2);
+				piece += '[';
+				piece.append(text.data() + from, to - from);
+				piece += ']';
+				parsed[r] = BasicJsonType::parse(piece);
+			} catch (...) {
+				failed[r] = 1;
+			}
+		};
+
+		// a thread that cannot be started (system_error at a thread limit) sends the whole text down
+		// the serial path; the threads already running are joined first, as destroying them unjoined
+		// would terminate
+		std::vector<std::thread> workers;
+		try {
+			for (std::size_t r = 1; r < runs.size(); ++r) workers.emplace_back(parseRun, r);
+		} catch (...) {
+			for (std::thread &t : workers) t.join();
+			return BasicJsonType::parse(text.data(), text.data() + text.size());
+		}
+
+		BasicJsonType result;
+		bool restFailed = false;
+		try {
+			std::string rest;
+			rest.reserve(text.size() - arrayBytes + 2);
+			rest.append(text.data(), split.arrayBegin);
+			rest += "[]";
+			rest.append(text.data() + split.arrayEnd, text.size() - split.arrayEnd);
+			result = BasicJsonType::parse(rest);
+		} catch (...) {
+			restFailed = true;
+		}
+		parseRun(0);
+		for (std::thread &t : workers) t.join();
+
+		if (restFailed || std::find(failed.begin(), failed.end(), 1) != failed.end())
+			return BasicJsonType::parse(text.data(), text.data() + text.size());
+
+		auto &array = result.at(arrayPath).template get_ref<typename BasicJsonType::array_t &>();
+		array.reserve(split.elements.size());
+		for (BasicJsonType &run : parsed)
+			for (BasicJsonType &item : run) array.push_back(std::move(item));
+		return result;
+	}
+
+	template <typename BasicJsonType = nlohmann::json>
+	BasicJsonType parallelParse(const char *first, const char *last,
+		const typename BasicJsonType::json_pointer &arrayPath = typename BasicJsonType::json_pointer(),
+		unsigned threads = 0, std::size_t minBytes = 256 * 1024) {
+		return parallelParse<BasicJsonType>(std::string_view(first, static_cast<std::size_t>(last - first)), arrayPath,
+			threads, minBytes);
+	}
+}
+
+#endif
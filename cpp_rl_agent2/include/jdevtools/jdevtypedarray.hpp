@@ -0,0 +1,75 @@
+#ifndef JDEVTOOLS_JDEVTYPEDARRAY_HPP
+#define JDEVTOOLS_JDEVTYPEDARRAY_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jdevtools {
+	// Packs arrays of numbers into json binary values tagged as RFC 8746 typed arrays
+	// (little-endian layout). to_cbor() writes the subtype as the CBOR tag, and
+	// from_cbor(..., cbor_tag_handler_t::store) reads it back, so a whole array costs one
+	// byte-string header plus a memcpy in either direction.
+	template <typename T>
+	struct typedArrayTag;
+	template <> struct typedArrayTag<std::uint8_t> { static constexpr std::uint64_t value = 64; };
+	template <> struct typedArrayTag<std::uint16_t> { static constexpr std::uint64_t value = 69; };
+	template <> struct typedArrayTag<std::uint32_t> { static constexpr std::uint64_t value = 70; };
+	template <> struct typedArrayTag<std::uint64_t> { static constexpr std::uint64_t value = 71; };
+	template <> struct typedArrayTag<std::int8_t> { static constexpr std::uint64_t value = 72; };
+	template <> struct typedArrayTag<std::int16_t> { static constexpr std::uint64_t value = 77; };
+	template <> struct typedArrayTag<std::int32_t> { static constexpr std::uint64_t value = 78; };
+	template <> struct typedArrayTag<std::int64_t> { static constexpr std::uint64_t value = 79; };
+	template <> struct typedArrayTag<float> { static constexpr std::uint64_t value = 85; };
+	template <> struct typedArrayTag<double> { static constexpr std::uint64_t value = 86; };
+
+	inline bool hostIsLittleEndian() {
+		const std::uint16_t probe = 1;
+		unsigned char first;
+		std::memcpy(&first, &probe, 1);
+		return first == 1;
+	}
+
+	inline void reverseElementBytes(unsigned char *p, std::size_t count, std::size_t width) {
+		for (std::size_t i = 0; i < count; ++i, p += width)
+			for (std::size_t a = 0, b = width - 1; a < b; ++a, --b) std::swap(p[a], p[b]);
+	}
+
+	template <typename T, typename BinaryType = nlohmann::json::binary_t>
+	BinaryType packTypedArray(const T *data, std::size_t count) {
+		static_assert(std::is_arithmetic<T>::value, "typed arrays hold numbers only");
+		typename BinaryType::container_type bytes(count * sizeof(T));
+		if (count) std::memcpy(bytes.data(), data, bytes.size());
+		if (!hostIsLittleEndian() && sizeof(T) > 1) reverseElementBytes(bytes.data(), count, sizeof(T));
+		return BinaryType(std::move(bytes), typedArrayTag<T>::value);
+	}
+
+	template <typename T, typename BinaryType = nlohmann::json::binary_t>
+	BinaryType packTypedArray(const std::vector<T> &values) {
+		return packTypedArray<T, BinaryType>(values.data(), values.size());
+	}
+
+	// Throws std::runtime_error if the value was not packed as an array of T.
+	template <typename T, typename BinaryType = nlohmann::json::binary_t>
+	std::vector<T> unpackTypedArray(const BinaryType &bin) {
+		static_assert(std::is_arithmetic<T>::value, "typed arrays hold numbers only");
+		if (!bin.has_subtype() || bin.subtype() != typedArrayTag<T>::value)
+			throw std::runtime_error("unpackTypedArray: expected typed array tag " + std::to_string(typedArrayTag<T>::value));
+		if (bin.size() % sizeof(T))
+			throw std::runtime_error("unpackTypedArray: " + std::to_string(bin.size()) + " bytes is not a whole number of elements");
+		std::vector<T> values(bin.size() / sizeof(T));
+		if (!values.empty()) std::memcpy(values.data(), bin.data(), bin.size());
+		if (!hostIsLittleEndian() && sizeof(T) > 1)
+			reverseElementBytes(reinterpret_cast<unsigned char *>(values.data()), values.size(), sizeof(T));
+		return values;
+	}
+}
+
+#endif
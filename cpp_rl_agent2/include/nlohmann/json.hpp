@@ -6629,6 +6629,25 @@ class iterator_input_adapter
         return count * sizeof(T);
     }
 
+    // the functions below are only valid for contiguous byte ranges (see is_contiguous_input_adapter);
+    // they let the lexer scan the unread input in bulk
+
+    std::size_t contiguous_remaining() const
+    {
+        return static_cast<std::size_t>(std::distance(current, end));
+    }
+
+    const char* contiguous_data() const
+    {
+        JSON_ASSERT(current != end);
+        return reinterpret_cast<const char*>(std::addressof(*current));
+    }
+
+    void contiguous_skip(std::size_t count)
+    {
+        std::advance(current, static_cast<typename std::iterator_traits<IteratorType>::difference_type>(count));
+    }
+
   private:
     IteratorType current;
     IteratorType end;
@@ -6642,6 +6661,32 @@ class iterator_input_adapter
     }
 };
 
+/// whether an iterator walks over bytes stored contiguously in memory
+template<typename IteratorType>
+struct is_contiguous_byte_iterator
+{
+    using value_type = typename std::iterator_traits<IteratorType>::value_type;
+    enum
+    {
+        value = sizeof(value_type) == 1 && std::is_integral<value_type>::value &&
+                (std::is_pointer<IteratorType>::value ||
+                 std::is_same<IteratorType, typename std::string::iterator>::value ||
+                 std::is_same<IteratorType, typename std::string::const_iterator>::value ||
+                 std::is_same<IteratorType, typename std::vector<char>::iterator>::value ||
+                 std::is_same<IteratorType, typename std::vector<char>::const_iterator>::value ||
+                 std::is_same<IteratorType, typename std::vector<unsigned char>::iterator>::value ||
+                 std::is_same<IteratorType, typename std::vector<unsigned char>::const_iterator>::value)
+    };
+};
+
+/// whether the lexer may scan an input adapter in bulk
+template<typename InputAdapterType>
+struct is_contiguous_input_adapter : std::false_type {};
+
+template<typename IteratorType>
+struct is_contiguous_input_adapter<iterator_input_adapter<IteratorType>>
+    : std::integral_constant<bool, is_contiguous_byte_iterator<IteratorType>::value> {};
+
 template<typename BaseInputAdapter, size_t T>
 struct wide_string_input_helper;
 
@@ -7030,10 +7075,338 @@ NLOHMANN_JSON_NAMESPACE_END
 // #include <nlohmann/detail/meta/type_traits.hpp>
 
 
+// SSE2/AVX2 fast paths for whitespace and plain string bytes on contiguous inputs
+#ifndef JSON_USE_SIMD_LEXER
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define JSON_USE_SIMD_LEXER 1
+    #else
+        #define JSON_USE_SIMD_LEXER 0
+    #endif
+#endif
+
+#if JSON_USE_SIMD_LEXER
+    #include <emmintrin.h> // _mm_loadu_si128, _mm_cmpeq_epi8, _mm_movemask_epi8
+    #if defined(__AVX2__)
+        #include <immintrin.h> // _mm256_loadu_si256, _mm256_cmpeq_epi8, _mm256_movemask_epi8
+    #endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h> // _BitScanForward, _BitScanReverse
+#endif
+
+#include <cfloat> // FLT_EVAL_METHOD
+#include <cstdint> // uint64_t
+#include <limits> // numeric_limits
+
+// exact, locale-independent std::from_chars for floating-point numbers
+#ifndef JSON_HAS_FLOAT_FROM_CHARS
+    #if defined(JSON_HAS_CPP_17) && defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        #define JSON_HAS_FLOAT_FROM_CHARS 1
+    #else
+        #define JSON_HAS_FLOAT_FROM_CHARS 0
+    #endif
+#endif
+
+#if JSON_HAS_FLOAT_FROM_CHARS
+    #include <charconv> // from_chars
+#endif
+
 NLOHMANN_JSON_NAMESPACE_BEGIN
 namespace detail
 {
 
+////////////////////////
+// bulk lexer helpers //
+////////////////////////
+
+/// index of the lowest set bit; @a x must not be 0
+inline int lowest_bit(std::uint32_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, x);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while ((x & 1u) == 0)
+    {
+        x >>= 1u;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/// index of the highest set bit; @a x must not be 0
+inline int highest_bit(std::uint32_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - __builtin_clz(x);
+#elif defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse(&index, x);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while ((x >>= 1u) != 0)
+    {
+        ++index;
+    }
+    return index;
+#endif
+}
+
+inline int count_bits(std::uint32_t x) noexcept
+{
+    x = x - ((x >> 1u) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2u) & 0x33333333u);
+    return static_cast<int>((((x + (x >> 4u)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24u);
+}
+
+/*!
+@brief length of the whitespace run at the beginning of a byte range
+
+@param[in] p       first byte
+@param[in] n       number of bytes available
+@param[out] newlines      number of line feeds inside the run
+@param[out] last_newline  index of the last line feed inside the run (only set if @a newlines > 0)
+*/
+inline std::size_t whitespace_run_length(const char* p, std::size_t n, std::size_t& newlines, std::size_t& last_newline) noexcept
+{
+    std::size_t i = 0;
+    newlines = 0;
+
+    const auto note_newlines = [&](std::uint32_t nl_mask, std::size_t offset)
+    {
+        if (nl_mask != 0)
+        {
+            newlines += static_cast<std::size_t>(count_bits(nl_mask));
+            last_newline = offset + static_cast<std::size_t>(highest_bit(nl_mask));
+        }
+    };
+
+#if JSON_USE_SIMD_LEXER
+#if defined(__AVX2__)
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i nl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+        const __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                                           _mm256_or_si256(nl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        const auto ws_mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(ws));
+        auto nl_mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(nl));
+        if (ws_mask != 0xFFFFFFFFu)
+        {
+            const auto run = static_cast<std::size_t>(lowest_bit(~ws_mask));
+            note_newlines(nl_mask & ((1u << run) - 1u), i);
+            return i + run;
+        }
+        note_newlines(nl_mask, i);
+    }
+#endif
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+        const __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                                        _mm_or_si128(nl, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        const auto ws_mask = static_cast<std::uint32_t>(_mm_movemask_epi8(ws));
+        const auto nl_mask = static_cast<std::uint32_t>(_mm_movemask_epi8(nl));
+        if (ws_mask != 0xFFFFu)
+        {
+            const auto run = static_cast<std::size_t>(lowest_bit(~ws_mask));
+            note_newlines(nl_mask & ((1u << run) - 1u), i);
+            return i + run;
+        }
+        note_newlines(nl_mask, i);
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        const char c = p[i];
+        if (c == '\n')
+        {
+            ++newlines;
+            last_newline = i;
+        }
+        else if (c != ' ' && c != '\t' && c != '\r')
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/*!
+@brief parse the digits of a number token into a mantissa and a decimal exponent
+
+@param[in] first  first byte of the token (optional minus sign included)
+@param[in] last   end of the token
+@param[in] decimal_point  pointer to the decimal point inside the token or nullptr;
+                          the byte itself is not inspected as it may be locale-specific
+@param[out] negative  whether the token starts with a minus sign
+@param[out] mantissa  significant digits without leading zeros
+@param[out] exponent  power of ten to scale @a mantissa with
+
+@return false if the mantissa has more than 19 significant digits or the
+        exponent is out of any useful range
+*/
+inline bool decompose_decimal(const char* first, const char* last, const char* decimal_point,
+                              bool& negative, std::uint64_t& mantissa, int& exponent) noexcept
+{
+    const char* p = first;
+    negative = (p != last && *p == '-');
+    if (negative)
+    {
+        ++p;
+    }
+
+    mantissa = 0;
+    exponent = 0;
+    int digits = 0;
+    for (; p != last; ++p)
+    {
+        if (p == decimal_point)
+        {
+            continue;
+        }
+        if (*p < '0' || *p > '9')
+        {
+            break;
+        }
+        if (digits != 0 || *p != '0')
+        {
+            if (++digits > 19)
+            {
+                return false;
+            }
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+        }
+        if (decimal_point != nullptr && p > decimal_point)
+        {
+            --exponent;
+        }
+    }
+
+    if (p != last)
+    {
+        // exponent part; the token was validated by the state machine
+        ++p;
+        const bool negative_exponent = (*p == '-');
+        if (*p == '-' || *p == '+')
+        {
+            ++p;
+        }
+        int value = 0;
+        for (; p != last; ++p)
+        {
+            if (value > 10000)
+            {
+                return false;
+            }
+            value = value * 10 + (*p - '0');
+        }
+        exponent += negative_exponent ? -value : value;
+    }
+
+    return true;
+}
+
+/*!
+@brief exact conversion of short decimal numbers (Clinger's fast path)
+
+If the mantissa fits into 53 bits and the power of ten is at most 22, both
+are exactly representable as double and a single IEEE multiplication or
+division yields the correctly rounded result.
+
+@return true if @a result holds the correctly rounded value
+*/
+inline bool fast_path_to_double(bool negative, std::uint64_t mantissa, int exponent, double& result) noexcept
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    static constexpr double powers_of_ten[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    if (!std::numeric_limits<double>::is_iec559 || mantissa > (std::uint64_t(1) << 53u) || exponent < -22 || exponent > 22)
+    {
+        return false;
+    }
+
+    double value = static_cast<double>(mantissa);
+    if (exponent < 0)
+    {
+        value /= powers_of_ten[-exponent];
+    }
+    else
+    {
+        value *= powers_of_ten[exponent];
+    }
+    result = negative ? -value : value;
+    return true;
+#else
+    // intermediate results may carry extra precision and round twice
+    static_cast<void>(negative);
+    static_cast<void>(mantissa);
+    static_cast<void>(exponent);
+    static_cast<void>(result);
+    return false;
+#endif
+}
+
+/*!
+@brief length of the run of string bytes that need neither unescaping nor
+UTF-8 validation (0x20..0x7F except quotation mark and reverse solidus)
+*/
+inline std::size_t plain_string_run_length(const char* p, std::size_t n) noexcept
+{
+    std::size_t i = 0;
+
+#if JSON_USE_SIMD_LEXER
+#if defined(__AVX2__)
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        // signed comparison: bytes 0x80..0xFF are negative and hence also below 0x20
+        const __m256i stop = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), v),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(stop));
+        if (mask != 0)
+        {
+            return i + static_cast<std::size_t>(lowest_bit(mask));
+        }
+    }
+#endif
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i stop = _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(0x20)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(stop));
+        if (mask != 0)
+        {
+            return i + static_cast<std::size_t>(lowest_bit(mask));
+        }
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        const auto c = static_cast<unsigned char>(p[i]);
+        if (c < 0x20 || c >= 0x80 || c == '\"' || c == '\\')
+        {
+            break;
+        }
+    }
+    return i;
+}
+
 ///////////
 // lexer //
 ///////////
@@ -7110,6 +7483,12 @@ class lexer_base
         }
     }
 };
+
+/// BasicJsonType's allocator rebound to T; parser scratch storage uses it, so
+/// documents with a custom allocator (arenas) parse without touching the heap
+template<typename BasicJsonType, typename T>
+using json_rebind_alloc_t = typename std::allocator_traits<typename BasicJsonType::allocator_type>::template rebind_alloc<T>;
+
 /*!
 @brief lexical analysis
 
@@ -7269,6 +7648,9 @@ class lexer : public lexer_base<BasicJsonType>
 
         while (true)
         {
+            // take bytes that need no further checks in bulk
+            scan_string_run(is_contiguous_input_adapter<InputAdapterType> {});
+
             // get next character
             switch (get())
             {
@@ -7934,6 +8316,96 @@ class lexer : public lexer_base<BasicJsonType>
         f = std::strtold(str, endptr);
     }
 
+    /*!
+    @brief convert token_buffer to a floating-point number without strtod
+
+    Short numbers take Clinger's exact fast path; everything else goes through
+    std::from_chars (correctly rounded, locale-independent) where available.
+
+    @return false if the caller has to fall back to strtof (no from_chars,
+            result out of range, or an unsupported floating-point type)
+    */
+    bool convert_float(double& f)
+    {
+        const char* first = token_buffer.data();
+        const char* last = first + token_buffer.size();
+        const char* decimal_point = decimal_point_position != std::string::npos ? first + decimal_point_position : nullptr;
+
+        bool negative = false;
+        std::uint64_t mantissa = 0;
+        int exponent = 0;
+        if (decompose_decimal(first, last, decimal_point, negative, mantissa, exponent)
+                && fast_path_to_double(negative, mantissa, exponent, f))
+        {
+            return true;
+        }
+
+        return convert_float_from_chars(f);
+    }
+
+    bool convert_float(float& f)
+    {
+        return convert_float_from_chars(f);
+    }
+
+    template<typename FloatType>
+    bool convert_float_from_chars(FloatType& f)
+    {
+#if JSON_HAS_FLOAT_FROM_CHARS
+        // from_chars always expects '.', while token_buffer holds the locale's decimal point
+        if (decimal_point_position != std::string::npos)
+        {
+            token_buffer[decimal_point_position] = '.';
+        }
+
+        const char* first = token_buffer.data();
+        const char* last = first + token_buffer.size();
+        const auto result = std::from_chars(first, last, f);
+
+        if (decimal_point_position != std::string::npos)
+        {
+            token_buffer[decimal_point_position] = static_cast<typename string_t::value_type>(decimal_point_char);
+        }
+        return result.ec == std::errc() && result.ptr == last;
+#else
+        static_cast<void>(f);
+        return false;
+#endif
+    }
+
+    template<typename FloatType>
+    bool convert_float(FloatType& /*unused*/) noexcept
+    {
+        return false;
+    }
+
+    /// convert token_buffer to an integer if it is short enough not to overflow
+    template<typename NumberType>
+    bool convert_short_integer(NumberType& value) const noexcept
+    {
+        const bool negative = token_buffer[0] == '-';
+        const std::size_t digits = token_buffer.size() - (negative ? 1 : 0);
+        if (digits > 18)
+        {
+            return false;
+        }
+
+        std::uint64_t magnitude = 0;
+        for (std::size_t i = negative ? 1 : 0; i < token_buffer.size(); ++i)
+        {
+            magnitude = magnitude * 10 + static_cast<std::uint64_t>(token_buffer[i] - '0');
+        }
+
+        // 18 digits always fit into int64_t; the range of NumberType is checked below
+        const std::int64_t signed_value = negative ? -static_cast<std::int64_t>(magnitude) : static_cast<std::int64_t>(magnitude);
+        if (!value_in_range_of<NumberType>(signed_value))
+        {
+            return false;
+        }
+        value = static_cast<NumberType>(signed_value);
+        return true;
+    }
+
     /*!
     @brief scan a number literal
 
@@ -8073,6 +8545,7 @@ scan_number_zero:
 
 scan_number_any1:
         // state: we just parsed a number 0-9 (maybe with a leading minus sign)
+        scan_digit_run(is_contiguous_input_adapter<InputAdapterType> {});
         switch (get())
         {
             case '0':
@@ -8137,6 +8610,7 @@ scan_number_decimal1:
 
 scan_number_decimal2:
         // we just parsed at least one number after a decimal point
+        scan_digit_run(is_contiguous_input_adapter<InputAdapterType> {});
         switch (get())
         {
             case '0':
@@ -8228,6 +8702,7 @@ scan_number_sign:
 
 scan_number_any2:
         // we just parsed a number after the exponent or exponent sign
+        scan_digit_run(is_contiguous_input_adapter<InputAdapterType> {});
         switch (get())
         {
             case '0':
@@ -8254,6 +8729,20 @@ scan_number_done:
         // we are done scanning a number)
         unget();
 
+        // short integers and most floats are converted without the C library
+        if (number_type == token_type::value_unsigned && convert_short_integer(value_unsigned))
+        {
+            return token_type::value_unsigned;
+        }
+        if (number_type == token_type::value_integer && convert_short_integer(value_integer))
+        {
+            return token_type::value_integer;
+        }
+        if (number_type == token_type::value_float && convert_float(value_float))
+        {
+            return token_type::value_float;
+        }
+
         char* endptr = nullptr; // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
         errno = 0;
 
@@ -8414,6 +8903,101 @@ scan_number_done:
         token_buffer.push_back(static_cast<typename string_t::value_type>(c));
     }
 
+    /////////////////////
+    // bulk scanning
+    /////////////////////
+
+    // The functions below consume input directly from contiguous adapters. They
+    // keep position and token_string exactly as the equivalent get() calls would.
+
+    /// consume the whitespace that follows the current (whitespace) character
+    void skip_whitespace_run(std::false_type /*unused*/) noexcept {}
+
+    void skip_whitespace_run(std::true_type /*unused*/)
+    {
+        const std::size_t available = ia.contiguous_remaining();
+        if (next_unget || available == 0)
+        {
+            return;
+        }
+
+        const char* first = ia.contiguous_data();
+        std::size_t newlines = 0;
+        std::size_t last_newline = 0;
+        const std::size_t length = whitespace_run_length(first, available, newlines, last_newline);
+        if (length == 0)
+        {
+            return;
+        }
+
+        token_string.insert(token_string.end(), reinterpret_cast<const char_type*>(first), reinterpret_cast<const char_type*>(first + length));
+        position.chars_read_total += length;
+        if (newlines == 0)
+        {
+            position.chars_read_current_line += length;
+        }
+        else
+        {
+            position.lines_read += newlines;
+            position.chars_read_current_line = length - last_newline - 1;
+        }
+        ia.contiguous_skip(length);
+    }
+
+    /// copy the digits that follow the current (digit) character of a number
+    void scan_digit_run(std::false_type /*unused*/) noexcept {}
+
+    void scan_digit_run(std::true_type /*unused*/)
+    {
+        const std::size_t available = ia.contiguous_remaining();
+        if (next_unget || available == 0)
+        {
+            return;
+        }
+
+        const char* first = ia.contiguous_data();
+        std::size_t length = 0;
+        while (length < available && first[length] >= '0' && first[length] <= '9')
+        {
+            ++length;
+        }
+        if (length == 0)
+        {
+            return;
+        }
+
+        token_buffer.insert(token_buffer.end(), first, first + length);
+        token_string.insert(token_string.end(), reinterpret_cast<const char_type*>(first), reinterpret_cast<const char_type*>(first + length));
+        position.chars_read_total += length;
+        position.chars_read_current_line += length;
+        ia.contiguous_skip(length);
+    }
+
+    /// copy the string bytes that need neither unescaping nor UTF-8 checks
+    void scan_string_run(std::false_type /*unused*/) noexcept {}
+
+    void scan_string_run(std::true_type /*unused*/)
+    {
+        const std::size_t available = ia.contiguous_remaining();
+        if (next_unget || available == 0)
+        {
+            return;
+        }
+
+        const char* first = ia.contiguous_data();
+        const std::size_t length = plain_string_run_length(first, available);
+        if (length == 0)
+        {
+            return;
+        }
+
+        token_buffer.insert(token_buffer.end(), first, first + length);
+        token_string.insert(token_string.end(), reinterpret_cast<const char_type*>(first), reinterpret_cast<const char_type*>(first + length));
+        position.chars_read_total += length;
+        position.chars_read_current_line += length;
+        ia.contiguous_skip(length);
+    }
+
   public:
     /////////////////////
     // value getters
@@ -8515,11 +9099,12 @@ scan_number_done:
 
     void skip_whitespace()
     {
-        do
+        get();
+        while (current == ' ' || current == '\t' || current == '\n' || current == '\r')
         {
+            skip_whitespace_run(is_contiguous_input_adapter<InputAdapterType> {});
             get();
         }
-        while (current == ' ' || current == '\t' || current == '\n' || current == '\r');
     }
 
     token_type scan()
@@ -8627,7 +9212,7 @@ scan_number_done:
     position_t position {};
 
     /// raw input token string (for error messages)
-    std::vector<char_type> token_string {};
+    std::vector<char_type, json_rebind_alloc_t<BasicJsonType, char_type>> token_string {};
 
     /// buffer for variable-length tokens (numbers, strings)
     string_t token_buffer {};
@@ -9093,7 +9678,7 @@ class json_sax_dom_parser
     /// the parsed JSON value
     BasicJsonType& root;
     /// stack to model hierarchy of values
-    std::vector<BasicJsonType*> ref_stack {};
+    std::vector<BasicJsonType*, json_rebind_alloc_t<BasicJsonType, BasicJsonType*>> ref_stack {};
     /// helper to hold the reference for the next object element
     BasicJsonType* object_element = nullptr;
     /// whether a syntax error occurred
@@ -9522,11 +10107,11 @@ class json_sax_dom_callback_parser
     /// the parsed JSON value
     BasicJsonType& root;
     /// stack to model hierarchy of values
-    std::vector<BasicJsonType*> ref_stack {};
+    std::vector<BasicJsonType*, json_rebind_alloc_t<BasicJsonType, BasicJsonType*>> ref_stack {};
     /// stack to manage which values to keep
-    std::vector<bool> keep_stack {}; // NOLINT(readability-redundant-member-init)
+    std::vector<bool, json_rebind_alloc_t<BasicJsonType, bool>> keep_stack {}; // NOLINT(readability-redundant-member-init)
     /// stack to manage which object keys to keep
-    std::vector<bool> key_keep_stack {}; // NOLINT(readability-redundant-member-init)
+    std::vector<bool, json_rebind_alloc_t<BasicJsonType, bool>> key_keep_stack {}; // NOLINT(readability-redundant-member-init)
     /// helper to hold the reference for the next object element
     BasicJsonType* object_element = nullptr;
     /// whether a syntax error occurred
@@ -13024,7 +13609,7 @@ class parser
     {
         // stack to remember the hierarchy of structured values we are parsing
         // true = array; false = object
-        std::vector<bool> states;
+        std::vector<bool, json_rebind_alloc_t<BasicJsonType, bool>> states;
         // value to avoid a goto (see comment where set to true)
         bool skip_to_state_evaluation = false;
 
@@ -14270,8 +14855,10 @@ class iter_impl // NOLINT(cppcoreguidelines-special-member-functions,hicpp-speci
     /*!
     @brief return the key of an object iterator
     @pre The iterator is initialized; i.e. `m_object != nullptr`.
+    @note Returned as string_t, so object types whose key_type only converts
+    to the string type (interned keys) still hand out a plain string.
     */
-    const typename object_t::key_type& key() const
+    const typename BasicJsonType::string_t& key() const
     {
         JSON_ASSERT(m_object != nullptr);
 
@@ -15258,7 +15845,7 @@ class json_pointer
                     // iterate object and use keys as reference string
                     for (const auto& element : *value.m_data.m_value.object)
                     {
-                        flatten(detail::concat<string_t>(reference_string, '/', detail::escape(element.first)), element.second, result);
+                        flatten(detail::concat<string_t>(reference_string, '/', detail::escape<string_t>(element.first)), element.second, result);
                     }
                 }
                 break;
@@ -18899,6 +19486,13 @@ class serializer
                     return;
                 }
 
+                if (is_number_array(*val.m_data.m_value.array)
+                        && (!pretty_print || current_indent + indent_step <= max_number_array_indent))
+                {
+                    dump_number_array(*val.m_data.m_value.array, pretty_print, indent_step, current_indent);
+                    return;
+                }
+
                 if (pretty_print)
                 {
                     o->write_characters("[\n", 2);
@@ -19418,6 +20012,21 @@ class serializer
                    std::is_same<NumberType, binary_char_t>::value,
                    int > = 0 >
     void dump_integer(NumberType x)
+    {
+        char* end = format_integer(x, number_buffer.data());
+        o->write_characters(number_buffer.data(), static_cast<std::size_t>(end - number_buffer.data()));
+    }
+
+    /*!
+    @brief format an integer
+
+    Writes the decimal representation of @a x to @a first, which must have
+    room for at least 21 characters.
+
+    @return one past the last character written
+    */
+    template<typename NumberType>
+    char* format_integer(NumberType x, char* first)
     {
         static constexpr std::array<std::array<char, 2>, 100> digits_to_99
         {
@@ -19438,12 +20047,12 @@ class serializer
         // special case for "0"
         if (x == 0)
         {
-            o->write_character('0');
-            return;
+            *first = '0';
+            return first + 1;
         }
 
         // use a pointer to fill the buffer
-        auto buffer_ptr = number_buffer.begin(); // NOLINT(llvm-qualified-auto,readability-qualified-auto,cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+        char* buffer_ptr = first;
 
         number_unsigned_t abs_value;
 
@@ -19463,9 +20072,6 @@ class serializer
             n_chars = count_digits(abs_value);
         }
 
-        // spare 1 byte for '\0'
-        JSON_ASSERT(n_chars < number_buffer.size() - 1);
-
         // jump to the end to generate the string from backward,
         // so we later avoid reversing the result
         buffer_ptr += n_chars;
@@ -19491,7 +20097,7 @@ class serializer
             *(--buffer_ptr) = static_cast<char>('0' + abs_value);
         }
 
-        o->write_characters(number_buffer.data(), n_chars);
+        return first + n_chars;
     }
 
     /*!
@@ -19514,12 +20120,6 @@ class serializer
         // If number_float_t is an IEEE-754 single or double precision number,
         // use the Grisu2 algorithm to produce short numbers which are
         // guaranteed to round-trip, using strtof and strtod, resp.
-        //
-        // NB: The test below works if <long double> == <double>.
-        static constexpr bool is_ieee_single_or_double
-            = (std::numeric_limits<number_float_t>::is_iec559 && std::numeric_limits<number_float_t>::digits == 24 && std::numeric_limits<number_float_t>::max_exponent == 128) ||
-              (std::numeric_limits<number_float_t>::is_iec559 && std::numeric_limits<number_float_t>::digits == 53 && std::numeric_limits<number_float_t>::max_exponent == 1024);
-
         dump_float(x, std::integral_constant<bool, is_ieee_single_or_double>());
     }
 
@@ -19582,6 +20182,98 @@ class serializer
         }
     }
 
+    /*!
+    @brief check whether every element of a non-empty array is a number
+
+    Only used to pick dump_number_array(); floats count only when they can be
+    formatted with to_chars().
+    */
+    static bool is_number_array(const typename BasicJsonType::array_t& a) noexcept
+    {
+        return std::all_of(a.begin(), a.end(), [](const BasicJsonType & v)
+        {
+            return v.is_number_integer() || (is_ieee_single_or_double && v.is_number_float());
+        });
+    }
+
+    /*!
+    @brief dump an array whose elements are all numbers
+
+    Produces exactly what the generic array case would, but the elements are
+    formatted straight into @a array_buffer, and the output adapter gets one
+    write per filled buffer instead of two or three calls per element.
+    Indentation must not exceed @a max_number_array_indent.
+    */
+    void dump_number_array(const typename BasicJsonType::array_t& a,
+                           const bool pretty_print,
+                           const unsigned int indent_step,
+                           const unsigned int current_indent)
+    {
+        const auto new_indent = pretty_print ? current_indent + indent_step : 0;
+        if (JSON_HEDLEY_UNLIKELY(indent_string.size() < new_indent))
+        {
+            indent_string.resize(indent_string.size() * 2, ' ');
+        }
+
+        char* const begin = array_buffer.data();
+        char* const limit = begin + array_buffer.size() - max_number_length - max_number_array_indent - 2;
+        char* p = begin;
+
+        *p++ = '[';
+        for (auto i = a.cbegin(); i != a.cend(); ++i)
+        {
+            if (JSON_HEDLEY_UNLIKELY(p > limit))
+            {
+                o->write_characters(begin, static_cast<std::size_t>(p - begin));
+                p = begin;
+            }
+            if (i != a.cbegin())
+            {
+                *p++ = ',';
+            }
+            if (pretty_print)
+            {
+                *p++ = '\n';
+                p = std::copy(indent_string.data(), indent_string.data() + new_indent, p);
+            }
+
+            switch (i->m_data.m_type)
+            {
+                case value_t::number_integer:
+                    p = format_integer(i->m_data.m_value.number_integer, p);
+                    break;
+                case value_t::number_unsigned:
+                    p = format_integer(i->m_data.m_value.number_unsigned, p);
+                    break;
+                default:
+                {
+                    const number_float_t x = i->m_data.m_value.number_float;
+                    if (std::isfinite(x))
+                    {
+                        p = ::nlohmann::detail::to_chars(p, p + max_number_length, x);
+                    }
+                    else
+                    {
+                        p = std::copy_n("null", 4, p);
+                    }
+                    break;
+                }
+            }
+        }
+        if (JSON_HEDLEY_UNLIKELY(p > limit))
+        {
+            o->write_characters(begin, static_cast<std::size_t>(p - begin));
+            p = begin;
+        }
+        if (pretty_print)
+        {
+            *p++ = '\n';
+            p = std::copy(indent_string.data(), indent_string.data() + current_indent, p);
+        }
+        *p++ = ']';
+        o->write_characters(begin, static_cast<std::size_t>(p - begin));
+    }
+
     /*!
     @brief check whether a string is UTF-8 encoded
 
@@ -19681,6 +20373,18 @@ class serializer
     /// string buffer
     std::array<char, 512> string_buffer{{}};
 
+    /// NB: The test below works if <long double> == <double>.
+    static constexpr bool is_ieee_single_or_double
+        = (std::numeric_limits<number_float_t>::is_iec559 && std::numeric_limits<number_float_t>::digits == 24 && std::numeric_limits<number_float_t>::max_exponent == 128) ||
+          (std::numeric_limits<number_float_t>::is_iec559 && std::numeric_limits<number_float_t>::digits == 53 && std::numeric_limits<number_float_t>::max_exponent == 1024);
+
+    /// longest output of format_integer() or to_chars(), with margin
+    static constexpr std::size_t max_number_length = 32;
+    /// deepest indentation dump_number_array() handles; deeper arrays take the generic path
+    static constexpr unsigned int max_number_array_indent = 1024;
+    /// output buffer for dump_number_array()
+    std::array<char, 4096> array_buffer{{}};
+
     /// the indentation character
     const char indent_char;
     /// the indentation string
@@ -1,10 +1,19 @@
 #include "jdevtools/jdevcurl.hpp"
+#include "jdevtools/jdevintern.hpp"
+#include "jdevtools/jdevjsonview.hpp"
+#include "jdevtools/jdevjournal.hpp"
+#include "jdevtools/jdevjsonpath.hpp"
+#include "jdevtools/jdevjsonwriter.hpp"
+#include "jdevtools/jdevmmap.hpp"
+#include "jdevtools/jdevparallel.hpp"
+#include "jdevtools/jdevtypedarray.hpp"
 #include "nlohmann/json.hpp"
 
 #include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <optional>
 #include <queue>
 #include <random>
 #include <string>
@@ -29,6 +38,7 @@ static constexpr int S = GRID_SIZE * GRID_SIZE;
 
 inline static int TIME_DELAY = 6;
 inline static int VISUAL_MODE = 0;
+inline static int SAVE_MODE = 0;
 
 class GridAPI {
 public:
@@ -54,34 +64,44 @@ public:
 		};
 	}
 
+	// gw.php sends numbers either as numbers or as strings
+	static int intField(const optional<jsonView> &field) {
+		if (!field) throw out_of_range("missing field");
+		if (field->is_number()) return field->get<int>();
+		return stoi(field->get<string>());
+	}
+
 	static pair<pair<int, int>, double> makeMove(char direction) {
-		requestData req;
-		req.headers = haeders;
+		// the request, response text, index and results are kept between moves and only
+		// refilled, so once their buffers have grown a move allocates nothing on our side
+		static requestData req;
+		static string str;
+		static jsonIndex doc;
+		static vector<optional<jsonView> > js;
+		if (req.headers != haeders) req.headers = haeders;
 		req.url = "https://www.notexponential.com/aip2pgaming/api/rl/gw.php";
-		req.postData = "type=move&teamId=" + to_string(teamid1) + "&worldId=" + to_string(worldid1) + "&move=" + direction;
+		req.postData.assign("type=move&teamId=").append(to_string(teamid1));
+		req.postData.append("&worldId=").append(to_string(worldid1));
+		req.postData.append("&move=") += direction;
 
-		string str = sender(req, (req.postData.size()));
+		sender(req, str, req.postData.size());
 		cout << str;
-		json js = json::parse(str);
+		// only a few fields are needed, so read them through the index instead of building a DOM
+		static const pathSet<json> fields = {"/reward", "/newState/x", "/newState/y"};
+		doc.parse(str);
+		fields.extract(doc.root(), js);
 
-		if (!js.contains("reward")) {
+		if (!js[0]) {
 			cout << "\nno reward\n";
 			return {{-1, -1}, 0.0};
 		}
 
-		double reward = js["reward"];
+		double reward = js[0]->get<double>();
 		int r = -1, c = -1;
 
 		try {
-			if (js["newState"]["x"].is_number())
-				r = js["newState"]["x"];
-			else
-				r = stoi(js["newState"]["x"].get<string>());
-	
-			if (js["newState"]["y"].is_number())
-				c = js["newState"]["y"];
-			else
-				c = stoi(js["newState"]["y"].get<string>());
+			r = intField(js[1]);
+			c = intField(js[2]);
 		}
 		catch(const std::exception& e) {
 			r = -1, c = -1;
@@ -97,14 +117,14 @@ public:
 
 		string str = sender(req, (req.postData.size()));
 		cout << str << '\n';
-		json js = json::parse(str);
+		static const pathSet<json> fields = {"/world", "/state"};
+		jsonIndex doc(str);
+		vector<optional<jsonView> > js;
+		fields.extract(doc.root(), js);
 
 		int world = -1, r = -1, c = -1;
 
-		if (js["world"].is_number())
-			world = js["world"];
-		else
-			world = stoi(js["world"].get<string>());
+		world = intField(js[0]);
 
 		if (world != -1) {
 			requestData en;
@@ -120,7 +140,7 @@ public:
 			return {-1, -1};
 		}
 
-		str = js["state"].get<string>();
+		str = js[1].value().get<string>();
 		size_t p1 = str.find(':');
 		r = stoi(str.substr(0, p1));
 		c = stoi(str.substr(p1 + 1));
@@ -156,7 +176,24 @@ void to_json(nlohmann::json& j, const Cell& c) {
 	j["rewards"] = rewards_array;
 }
 
-void from_json(const nlohmann::json& j, Cell& c) {
+// Same layout as to_json, streamed without the intermediate json objects.
+void write(jsonWriter& w, const Cell& c) {
+	w.begin_object();
+	w.key("explored").value(c.explored);
+	w.key("rewards").value(c.rewards);
+	w.key("transitions").begin_array();
+	for (int i = 0; i < 4; ++i) {
+		w.begin_object();
+		w.key("x").value(c.transitions[i].first);
+		w.key("y").value(c.transitions[i].second);
+		w.end_object();
+	}
+	w.end_array();
+	w.end_object();
+}
+
+template <typename BasicJsonType>
+void from_json(const BasicJsonType& j, Cell& c) {
 	auto trans_array = j["transitions"];
 	auto explored_array = j["explored"];
 	auto rewards_array = j["rewards"];
@@ -189,36 +226,165 @@ class GridExplorer {
 	bool targetFound = false;
 	random_device rd;
 	mt19937 rng;
+	patchJournal<json> journal;
 
+	string savePath(const char *suffix) {
+		return "world_" + to_string(GridAPI::worldid1) + suffix;
+	}
+
+	// Binary checkpoint: the grid goes into three packed typed arrays inside a CBOR map, cells in
+	// row-major order with A entries per cell (two ints per entry for transitions), so saving and
+	// loading the world is a handful of memcpy's instead of a node per number.
+	void saveCheckpoint() {
+		const size_t rows = world.size(), cols = rows ? world[0].size() : 0;
+		vector<int32_t> transitions, explored;
+		vector<double> rewards;
+		transitions.reserve(rows * cols * A * 2);
+		explored.reserve(rows * cols * A);
+		rewards.reserve(rows * cols * A);
+		for (const auto &row: world) {
+			for (const Cell &cell: row) {
+				for (int k = 0; k < A; k++) {
+					transitions.push_back(cell.transitions[k].first);
+					transitions.push_back(cell.transitions[k].second);
+					explored.push_back(cell.explored[k]);
+					rewards.push_back(cell.rewards[k]);
+				}
+			}
+		}
+
+		json js;
+		js["version"] = 1;
+		js["rows"] = rows;
+		js["cols"] = cols;
+		js["transitions"] = packTypedArray(transitions);
+		js["explored"] = packTypedArray(explored);
+		js["rewards"] = packTypedArray(rewards);
+		js["knownCells"] = knownCells;
+		js["targetFound"] = targetFound;
+		js["targetPos"] = targetPos;
+		js["targetMove"] = targetMove;
+
+		ofstream file(savePath("_mapv2.cbor"), ios::binary);
+		json::to_cbor(js, file);
+	}
+
+	bool loadCheckpoint() {
+		mappedFile file(savePath("_mapv2.cbor"));
+		if (!file) return false;
+		json js = json::from_cbor(file.begin(), file.end(), true, true, json::cbor_tag_handler_t::store);
+		if (js["version"].get<int>() != 1) throw runtime_error("unsupported checkpoint version");
+		const size_t rows = js["rows"].get<size_t>(), cols = js["cols"].get<size_t>();
+		vector<int32_t> transitions = unpackTypedArray<int32_t>(js["transitions"].get_binary());
+		vector<int32_t> explored = unpackTypedArray<int32_t>(js["explored"].get_binary());
+		vector<double> rewards = unpackTypedArray<double>(js["rewards"].get_binary());
+		const size_t count = rows * cols * A;
+		if (transitions.size() != count * 2 || explored.size() != count || rewards.size() != count)
+			throw runtime_error("checkpoint arrays do not match the grid size");
+
+		world.assign(rows, vector<Cell>(cols));
+		size_t at = 0;
+		for (auto &row: world) {
+			for (Cell &cell: row) {
+				for (int k = 0; k < A; k++, at++) {
+					cell.transitions[k] = {transitions[at * 2], transitions[at * 2 + 1]};
+					cell.explored[k] = explored[at];
+					cell.rewards[k] = rewards[at];
+				}
+			}
+		}
+		knownCells = js["knownCells"].get<unordered_set<string> >();
+		targetFound = js["targetFound"].get<bool>();
+		targetPos = js["targetPos"].get<pair<int, int> >();
+		targetMove = js["targetMove"].get<char>();
+		return true;
+	}
+
+	json mapDocument() {
+		json js;
+		js["world"] = world;
+		js["knownCells"] = knownCells;
+		js["targetFound"] = targetFound;
+		js["targetPos"] = targetPos;
+		js["targetMove"] = targetMove;
+		return js;
+	}
+
+	template <typename BasicJsonType>
+	void loadMap(const BasicJsonType &js) {
+		// built per call: for internedJson the keys are interned in the table of the document being
+		// loaded (current under its scope), so they match its keys by address and never outlive it
+		const pathSet<BasicJsonType> fields = {"/world", "/knownCells", "/targetFound", "/targetPos", "/targetMove"};
+		vector<const BasicJsonType *> f;
+		fields.extract(js, f);
+		if (find(f.begin(), f.end(), nullptr) != f.end()) throw runtime_error("map file is missing a field");
+		world = f[0]->template get<vector<vector<Cell> > >();
+		knownCells = f[1]->template get<unordered_set<string> >();
+		targetFound = f[2]->template get<bool>();
+		targetPos = f[3]->template get<pair<int, int> >();
+		targetMove = f[4]->template get<char>();
+	}
+
+	// Journal mode: the text map is the snapshot and world_<id>_mapv2.log holds the patches since.
+	// Cells merged in from the Q-table files are folded in once here. Every change is flushed as
+	// soon as it is journaled, one log line per step, so a crash loses no more than modes 0 and 1
+	// would; the journal only saves on the size of what is written.
+	void startJournal() {
+		if (journal.document().is_null()) journal.reset(mapDocument());
+		else if (journal.document().at("knownCells").size() != knownCells.size())
+			journal.update(json::json_pointer("/knownCells"), knownCells);
+		journal.flush();
+	}
+
+	// Journal mode: a cell just added to knownCells.
+	void journalKnownCell(const pair<int, int> &pos) {
+		journal.append(json::json_pointer("/knownCells"), posToString(pos));
+		journal.flush();
+	}
+
+	// Journal mode: one explore() step only touches the cell it left and maybe adds a known cell.
+	void journalStep(const pair<int, int> &changed, bool newCell) {
+		json::json_pointer cell("/world/" + to_string(changed.first) + "/" + to_string(changed.second));
+		journal.update(cell, world[changed.first][changed.second]);
+		if (newCell) journalKnownCell(currentPos);
+		else journal.flush();
+	}
+
+	// Modes 0 and 1; journal mode records each step through journalStep() instead.
 	void save() {
+		if (SAVE_MODE == 1) {
+			saveCheckpoint();
+			return;
+		}
 		ofstream file("world_" + to_string(GridAPI::worldid1) + "_mapv2.json");
-		json saveData;
-		saveData["world"] = world;
-		saveData["knownCells"] = knownCells;
-		saveData["targetFound"] = targetFound;
-		saveData["targetPos"] = targetPos;
-		saveData["targetMove"] = targetMove;
-		file << saveData.dump(2);
+		// keys in the order dump() sorts them, so the file matches the old json-built output
+		jsonWriter saveData(file, 2);
+		saveData.begin_object();
+		saveData.key("knownCells").value(knownCells);
+		saveData.key("targetFound").value(targetFound);
+		saveData.key("targetMove").value(targetMove);
+		saveData.key("targetPos").value(targetPos);
+		saveData.key("world").value(world);
+		saveData.end_object();
 	}
 
 	void load() {
-		{
-			ifstream file("world_" + to_string(GridAPI::worldid1) + "_mapv2.json");
+		if (SAVE_MODE == 2) {
+			if (!journal.open(savePath("_mapv2.json"), savePath("_mapv2.log"))) return;
+			loadMap(journal.document());
+		} else if (SAVE_MODE != 1 || !loadCheckpoint()) {
+			mappedFile file("world_" + to_string(GridAPI::worldid1) + "_mapv2.json");
 			if (!file) return;
-			json js;
-			file >> js;
-			world = js["world"].get<vector<vector<Cell> > >();
-			knownCells = js["knownCells"].get<unordered_set<string> >();
-			targetFound = js["targetFound"].get<bool>();
-			targetPos = js["targetPos"].get<pair<int, int> >();
-			targetMove = js["targetMove"].get<char>();
+			// the map repeats the same five keys for every cell, so they are interned
+			internedDocument doc;
+			auto scope = doc.scope();
+			loadMap(doc.root() = parallelParse<internedJson>(file.begin(), file.end(), internedJson::json_pointer("/world")));
 		}
 
 		{
-			ifstream file("world_" + to_string(GridAPI::worldid1) + "_tabv2.json");
+			mappedFile file("world_" + to_string(GridAPI::worldid1) + "_tabv2.json");
 			if (file) {
-				json js;
-				file >> js;
+				json js = json::parse(file);
 				unordered_map<string, vector<double> > tab = js["Q"].get<unordered_map<string, vector<double> > >();
 				for (auto &cell: tab) {
 					if (!knownCells.count(cell.first)) knownCells.insert(cell.first);
@@ -227,10 +393,9 @@ class GridExplorer {
 		}
 
 		{
-			ifstream file("world_" + to_string(GridAPI::worldid1) + "_tab.json");
+			mappedFile file("world_" + to_string(GridAPI::worldid1) + "_tab.json");
 			if (file) {
-				json js;
-				file >> js;
+				json js = parallelParse(file.begin(), file.end(), json::json_pointer("/Q"));
 				vector<vector<double> > tab = js["Q"].get<vector<vector<double> > >();
 				for (int i = 0; i < S; i++) {
 					bool addit = false;
@@ -477,7 +642,7 @@ class GridExplorer {
 		const int MAX_STEPS = 5000;
 		int steps = 0;
 		int stuckCounter = 0;
-		knownCells.insert(posToString(currentPos));
+		if (knownCells.insert(posToString(currentPos)).second && SAVE_MODE == 2) journalKnownCell(currentPos);
 
 		while (!targetFound && steps < MAX_STEPS) {
 			auto wait_until = chrono::system_clock::now() + chrono::seconds(TIME_DELAY);
@@ -537,10 +702,12 @@ class GridExplorer {
 			}
 
 			// Update current position
+			pair<int, int> previousPos = currentPos;
 			currentPos = newPos;
-			knownCells.insert(posToString(currentPos));
+			bool newCell = knownCells.insert(posToString(currentPos)).second;
 
-			save();
+			if (SAVE_MODE == 2) journalStep(previousPos, newCell);
+			else save();
 			if (VISUAL_MODE) visualizeGrid();
 
 			// Print status occasionally
@@ -626,6 +793,7 @@ public:
 		// Get initial position
 		currentPos = GridAPI::getInitialPosition();
 		load();
+		if (SAVE_MODE == 2) startJournal();
 	}
 
 	void run(bool optimal = false) {
@@ -750,7 +918,7 @@ public:
 };
 
 int main(int argc, char **argv) {
-	int world1 = 3, userid1 = 3671, teamid1 = 1447, timedelay = 10, visual = 0;
+	int world1 = 3, userid1 = 3671, teamid1 = 1447, timedelay = 10, visual = 0, savemode = 0;
 	string argument = (argc > 1) ? (argv[1]) : ("-help");
 
 	cout << "total arguments: " << int((argc - 1) / 2) << "\n";
@@ -761,6 +929,7 @@ int main(int argc, char **argv) {
 		cout << "-world {which world we learning. default(3)}\n";
 		cout << "-time {time delay in seconds between moves. default(10)}\n";
 		cout << "-visual {1 - show map every move. 2 - show map and end program. default(0)}\n";
+		cout << "-save {0 - json text map. 1 - binary CBOR checkpoint. 2 - json map + patch journal. default(0)}\n";
 		return 0;
 	}
 
@@ -780,6 +949,8 @@ int main(int argc, char **argv) {
 			timedelay = stoi(argv[i + 1]);
 		else if (argument == "-visual")
 			visual = stoi(argv[i + 1]);
+		else if (argument == "-save")
+			savemode = stoi(argv[i + 1]);
 		else {
 			cout << "Error with param:{" << argument << "}\n";
 			return -1;
@@ -793,6 +964,7 @@ int main(int argc, char **argv) {
 
 	TIME_DELAY = timedelay;
 	VISUAL_MODE = visual;
+	SAVE_MODE = savemode;
 
 	GridExplorer explorer;
 	explorer.printStats();
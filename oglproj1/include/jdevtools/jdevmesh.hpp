@@ -0,0 +1,379 @@
+#ifndef JDEVTOOLS_JDEVMESH_HPP
+#define JDEVTOOLS_JDEVMESH_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace jdevtools {
+	// Collects interleaved float vertices of a fixed stride, keeping one copy of each distinct
+	// vertex. add() returns the index of the vertex, so feeding it every face corner in order
+	// yields a compact vertex array plus a real index buffer.
+	// Vertices are compared bit for bit (0.0f and -0.0f are different vertices, NaNs with the
+	// same bits are the same one). The lookup is an open-addressed table of indices into
+	// vertices(), hashed with a multiply-xorshift over the raw 32-bit words.
+	class vertexWelder {
+		std::vector<float> verts;
+		std::vector<unsigned> slots; // index into verts / stride, or empty
+		std::size_t stride;
+		unsigned count = 0;
+
+		static constexpr unsigned empty = ~0u;
+
+		std::size_t hash(const float *v) const {
+			std::uint64_t h = 0x9e3779b97f4a7c15ull;
+			for (std::size_t i = 0; i < stride; ++i) {
+				std::uint32_t w;
+				std::memcpy(&w, v + i, sizeof w);
+				h = (h ^ w) * 0xff51afd7ed558ccdull;
+				h ^= h >> 32;
+			}
+			return std::size_t(h);
+		}
+
+		void rehash(std::size_t capacity) {
+			slots.assign(capacity, empty);
+			for (unsigned i = 0; i < count; ++i) {
+				std::size_t s = hash(&verts[i * stride]) & (capacity - 1);
+				while (slots[s] != empty) s = (s + 1) & (capacity - 1);
+				slots[s] = i;
+			}
+		}
+
+	public:
+		// expected: number of distinct vertices to size the table for; it grows past that as needed
+		explicit vertexWelder(std::size_t stride, std::size_t expected = 0) : stride(stride) {
+			std::size_t capacity = 16;
+			while (capacity < expected * 2) capacity *= 2;
+			slots.assign(capacity, empty);
+			verts.reserve(expected * stride);
+		}
+
+		unsigned add(const float *v) {
+			if ((std::size_t(count) + 1) * 2 > slots.size()) rehash(slots.size() * 2);
+			const std::size_t mask = slots.size() - 1;
+			for (std::size_t s = hash(v) & mask;; s = (s + 1) & mask) {
+				unsigned at = slots[s];
+				if (at == empty) {
+					slots[s] = count;
+					verts.insert(verts.end(), v, v + stride);
+					return count++;
+				}
+				if (std::memcmp(&verts[at * stride], v, stride * sizeof(float)) == 0) return at;
+			}
+		}
+
+		unsigned size() const { return count; }
+		const std::vector<float> &vertices() const { return verts; }
+		// moves the unique vertices out; the welder is empty afterwards
+		std::vector<float> release() {
+			std::vector<float> out;
+			out.swap(verts);
+			slots.assign(16, empty);
+			count = 0;
+			return out;
+		}
+	};
+
+	// Post-transform cache efficiency of a triangle list, simulated on a FIFO cache:
+	// acmr = vertex shader runs per triangle (0.5 is ideal for a regular grid, 3 is no reuse),
+	// atvr = vertex shader runs per referenced vertex (1 is ideal).
+	struct vertexCacheStats {
+		float acmr = 0, atvr = 0;
+	};
+
+	namespace meshDetail {
+		// FIFO post-transform cache, tracked with one timestamp per vertex
+		class fifoCache {
+			std::vector<unsigned> stamp;
+			unsigned size, time;
+
+		public:
+			fifoCache(std::size_t vertexCount, unsigned size) : stamp(vertexCount, 0), size(size), time(size + 1) {}
+			// returns the number of misses for one triangle
+			unsigned add(const unsigned *tri) {
+				unsigned misses = 0;
+				for (int k = 0; k < 3; ++k)
+					if (time - stamp[tri[k]] > size) {
+						stamp[tri[k]] = time++;
+						++misses;
+					}
+				return misses;
+			}
+			void reset() { time += size + 1; }
+		};
+
+		// Forsyth's scoring: recently used vertices score high (the last triangle's three a bit less,
+		// so strips do not run forever), and vertices with few triangles left get a boost so they
+		// are finished off instead of being left behind as isolated triangles.
+		constexpr unsigned forsythCache = 32;
+		constexpr unsigned forsythValence = 32;
+
+		struct forsythTables {
+			float cache[forsythCache + 1];
+			float valence[forsythValence];
+			forsythTables() {
+				for (unsigned i = 0; i < forsythCache; ++i)
+					cache[i] = i < 3 ? 0.75f : std::pow(1.0f - float(i - 3) / float(forsythCache - 3), 1.5f);
+				cache[forsythCache] = 0; // not in cache
+				valence[0] = 0;
+				for (unsigned i = 1; i < forsythValence; ++i) valence[i] = 2.0f / std::sqrt(float(i));
+			}
+			float score(unsigned cachePosition, unsigned remaining) const {
+				if (remaining == 0) return -1.0f;
+				return cache[cachePosition] + valence[std::min(remaining, forsythValence - 1)];
+			}
+		};
+	}
+
+	inline vertexCacheStats analyzeVertexCache(const std::vector<unsigned> &idx, std::size_t vertexCount,
+	                                           unsigned cacheSize = 16) {
+		vertexCacheStats stats;
+		if (idx.size() < 3) return stats;
+		meshDetail::fifoCache cache(vertexCount, cacheSize);
+		std::size_t misses = 0;
+		for (std::size_t i = 0; i + 2 < idx.size(); i += 3) misses += cache.add(&idx[i]);
+		std::vector<char> used(vertexCount, 0);
+		std::size_t referenced = 0;
+		for (unsigned v : idx)
+			if (!used[v]) used[v] = 1, ++referenced;
+		stats.acmr = float(misses) / float(idx.size() / 3);
+		stats.atvr = float(misses) / float(referenced);
+		return stats;
+	}
+
+	// Reorders triangles for the post-transform vertex cache (Forsyth, "Linear-Speed Vertex Cache
+	// Optimisation"): greedily emits the best-scoring triangle that touches the simulated LRU
+	// cache, falling back to the next unemitted triangle in file order when none does.
+	inline void optimizeVertexCache(std::vector<unsigned> &idx, std::size_t vertexCount) {
+		using namespace meshDetail;
+		static const forsythTables tables;
+		const std::size_t tris = idx.size() / 3;
+		if (tris == 0) return;
+
+		// vertex -> live triangles; the first remaining[v] entries of a vertex's range are live
+		std::vector<unsigned> remaining(vertexCount, 0), offset(vertexCount + 1, 0), adjacency(tris * 3);
+		for (std::size_t i = 0; i < tris * 3; ++i) ++remaining[idx[i]];
+		for (std::size_t v = 0; v < vertexCount; ++v) offset[v + 1] = offset[v] + remaining[v];
+		{
+			std::vector<unsigned> fill(offset.begin(), offset.end() - 1);
+			for (std::size_t i = 0; i < tris * 3; ++i) adjacency[fill[idx[i]]++] = unsigned(i / 3);
+		}
+
+		std::vector<unsigned> cachePosition(vertexCount, forsythCache);
+		std::vector<float> vertexScore(vertexCount), triangleScore(tris, 0);
+		for (std::size_t v = 0; v < vertexCount; ++v) vertexScore[v] = tables.score(forsythCache, remaining[v]);
+		for (std::size_t i = 0; i < tris * 3; ++i) triangleScore[i / 3] += vertexScore[idx[i]];
+
+		std::vector<char> emitted(tris, 0);
+		std::vector<unsigned> out;
+		out.reserve(tris * 3);
+		unsigned cache[forsythCache + 3], next[forsythCache + 3];
+		unsigned cacheCount = 0;
+		std::size_t cursor = 0;
+		long best = -1;
+
+		while (out.size() < tris * 3) {
+			if (best < 0) {
+				while (emitted[cursor]) ++cursor;
+				best = long(cursor);
+			}
+			const unsigned *tri = &idx[std::size_t(best) * 3];
+			emitted[best] = 1;
+			out.insert(out.end(), tri, tri + 3);
+
+			// drop the triangle from its vertices' live lists
+			for (int k = 0; k < 3; ++k) {
+				unsigned v = tri[k];
+				unsigned *live = &adjacency[offset[v]];
+				unsigned *found = std::find(live, live + remaining[v], unsigned(best));
+				std::swap(*found, live[--remaining[v]]);
+			}
+
+			// the triangle's vertices move to the front, everything else shifts back
+			unsigned nextCount = 0;
+			for (int k = 0; k < 3; ++k)
+				if (std::find(next, next + nextCount, tri[k]) == next + nextCount) next[nextCount++] = tri[k];
+			for (unsigned i = 0; i < cacheCount; ++i)
+				if (std::find(next, next + nextCount, cache[i]) == next + nextCount) next[nextCount++] = cache[i];
+			std::copy(next, next + nextCount, cache);
+			cacheCount = nextCount;
+
+			for (unsigned i = 0; i < cacheCount; ++i) {
+				unsigned v = cache[i];
+				cachePosition[v] = i < forsythCache ? i : forsythCache;
+				float score = tables.score(cachePosition[v], remaining[v]);
+				float delta = score - vertexScore[v];
+				vertexScore[v] = score;
+				for (unsigned a = 0; a < remaining[v]; ++a) triangleScore[adjacency[offset[v] + a]] += delta;
+			}
+			if (cacheCount > forsythCache) cacheCount = forsythCache;
+
+			best = -1;
+			float bestScore = -1.0f;
+			for (unsigned i = 0; i < cacheCount; ++i) {
+				unsigned v = cache[i];
+				for (unsigned a = 0; a < remaining[v]; ++a) {
+					unsigned t = adjacency[offset[v] + a];
+					if (triangleScore[t] > bestScore) bestScore = triangleScore[t], best = long(t);
+				}
+			}
+		}
+		idx.swap(out);
+	}
+
+	// Reorders clusters of an already cache-optimized triangle list so that outward-facing
+	// clusters on the outside of the mesh come first and hide what is drawn after them.
+	// Clusters are cut where the cache restarts anyway (all three vertices miss) and, inside
+	// those, wherever the cluster so far is within threshold of the enclosing cluster's ACMR,
+	// so reordering costs at most that much cache efficiency. Positions are the first three
+	// floats of each stride-float vertex.
+	inline void optimizeOverdraw(std::vector<unsigned> &idx, const std::vector<float> &verts, std::size_t stride,
+		float threshold = 1.05f, unsigned cacheSize = 16) {
+		const std::size_t tris = idx.size() / 3, vertexCount = verts.size() / stride;
+		if (tris < 2) return;
+		meshDetail::fifoCache cache(vertexCount, cacheSize);
+
+		std::vector<std::size_t> hard;
+		for (std::size_t t = 0; t < tris; ++t)
+			if (cache.add(&idx[t * 3]) == 3) hard.push_back(t);
+		if (hard.empty() || hard[0] != 0) hard.insert(hard.begin(), 0);
+		hard.push_back(tris);
+
+		std::vector<std::size_t> starts;
+		for (std::size_t h = 0; h + 1 < hard.size(); ++h) {
+			const std::size_t first = hard[h], last = hard[h + 1];
+			cache.reset();
+			std::size_t misses = 0;
+			for (std::size_t t = first; t < last; ++t) misses += cache.add(&idx[t * 3]);
+			const float target = threshold * float(misses) / float(last - first);
+			cache.reset();
+			starts.push_back(first);
+			std::size_t runMisses = 0, runTris = 0;
+			for (std::size_t t = first; t < last; ++t) {
+				runMisses += cache.add(&idx[t * 3]);
+				if (float(runMisses) <= target * float(++runTris) && t + 1 < last) {
+					starts.push_back(t + 1);
+					cache.reset();
+					runMisses = runTris = 0;
+				}
+			}
+		}
+		starts.push_back(tris);
+
+		auto position = [&](unsigned v) { return &verts[std::size_t(v) * stride]; };
+		double meshCentroid[3] = { 0, 0, 0 };
+		for (std::size_t v = 0; v < vertexCount; ++v)
+			for (int k = 0; k < 3; ++k) meshCentroid[k] += position(unsigned(v))[k];
+		for (double &c : meshCentroid) c /= double(vertexCount);
+
+		const std::size_t clusters = starts.size() - 1;
+		std::vector<float> key(clusters);
+		for (std::size_t c = 0; c < clusters; ++c) {
+			double centroid[3] = { 0, 0, 0 }, normal[3] = { 0, 0, 0 }, area = 0;
+			for (std::size_t t = starts[c]; t < starts[c + 1]; ++t) {
+				const float *a = position(idx[t * 3]), *b = position(idx[t * 3 + 1]), *d = position(idx[t * 3 + 2]);
+				double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+				double e2[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+				double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+				                e1[0] * e2[1] - e1[1] * e2[0] };
+				double w = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				for (int k = 0; k < 3; ++k) {
+					centroid[k] += w * (a[k] + b[k] + d[k]) / 3;
+					normal[k] += n[k];
+				}
+				area += w;
+			}
+			double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			double dot = 0;
+			if (area > 0 && length > 0)
+				for (int k = 0; k < 3; ++k) dot += (centroid[k] / area - meshCentroid[k]) * normal[k] / length;
+			key[c] = float(dot);
+		}
+
+		std::vector<std::size_t> order(clusters);
+		std::iota(order.begin(), order.end(), std::size_t(0));
+		std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return key[a] > key[b]; });
+		std::vector<unsigned> out;
+		out.reserve(idx.size());
+		for (std::size_t c : order) out.insert(out.end(), idx.begin() + starts[c] * 3, idx.begin() + starts[c + 1] * 3);
+		idx.swap(out);
+	}
+
+	// Renumbers vertices in the order the index buffer first uses them, so vertex fetches walk
+	// the buffer forward; vertices no triangle uses are dropped. Returns the new vertex count.
+	inline std::size_t optimizeVertexFetch(std::vector<float> &verts, std::size_t stride, std::vector<unsigned> &idx) {
+		const std::size_t vertexCount = verts.size() / stride;
+		std::vector<unsigned> remap(vertexCount, ~0u);
+		std::vector<float> out;
+		out.reserve(verts.size());
+		unsigned count = 0;
+		for (unsigned &v : idx) {
+			if (remap[v] == ~0u) {
+				remap[v] = count++;
+				const auto from = verts.begin() + std::size_t(v) * stride;
+				out.insert(out.end(), from, from + stride);
+			}
+			v = remap[v];
+		}
+		verts.swap(out);
+		return count;
+	}
+
+	// Axis-aligned bounds of the positions (first three floats) of stride-float vertices.
+	struct vertexBounds {
+		glm::vec3 min = glm::vec3(0), max = glm::vec3(0);
+
+		vertexBounds() = default;
+		vertexBounds(const std::vector<float> &verts, std::size_t stride) {
+			if (verts.size() < 3) return;
+			min = max = glm::vec3(verts[0], verts[1], verts[2]);
+			for (std::size_t i = 0; i + 2 < verts.size(); i += stride) {
+				glm::vec3 p(verts[i], verts[i + 1], verts[i + 2]);
+				min = glm::min(min, p);
+				max = glm::max(max, p);
+			}
+		}
+
+		// scale and offset that map a unorm16 position back into the box: p = offset + q * scale
+		glm::vec3 scale() const { return max - min; }
+		glm::vec3 offset() const { return min; }
+	};
+
+	// 12-byte vertex: position as three unorm16 relative to the mesh bounds (GL_UNSIGNED_SHORT,
+	// normalized) and normal as signed 10:10:10:2 (GL_INT_2_10_10_10_REV, normalized).
+	struct packedVertex {
+		std::uint16_t position[3];
+		std::uint16_t padding;
+		std::uint32_t normal;
+	};
+	static_assert(sizeof(packedVertex) == 12, "packedVertex must stay 12 bytes");
+
+	// Packs position+normal float vertices (6 floats each) into packedVertex. Normals are
+	// renormalized first; an axis along which the bounds are flat packs to 0.
+	inline std::vector<packedVertex> quantizeVertices(const std::vector<float> &verts, const vertexBounds &bounds) {
+		const glm::vec3 extent = bounds.scale();
+		const glm::vec3 inverse(extent.x > 0 ? 1 / extent.x : 0, extent.y > 0 ? 1 / extent.y : 0,
+		                        extent.z > 0 ? 1 / extent.z : 0);
+		std::vector<packedVertex> out(verts.size() / 6);
+		for (std::size_t v = 0; v < out.size(); ++v) {
+			const float *f = &verts[v * 6];
+			glm::vec3 q = (glm::vec3(f[0], f[1], f[2]) - bounds.min) * inverse;
+			for (int k = 0; k < 3; ++k) out[v].position[k] = glm::packUnorm1x16(q[k]);
+			out[v].padding = 0;
+			glm::vec3 n(f[3], f[4], f[5]);
+			float length = glm::length(n);
+			out[v].normal = glm::packSnorm3x10_1x2(glm::vec4(length > 0 ? n / length : n, 0.0f));
+		}
+		return out;
+	}
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef JDEVTOOLS_JDEVMESHCACHE_HPP
+#define JDEVTOOLS_JDEVMESHCACHE_HPP
+
+#include "jdevtools/jdevmmap.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace jdevtools {
+	// 64-bit hash of a byte range, eight bytes per step; used to tell whether a cache was built
+	// from the file that is on disk now.
+	inline std::uint64_t hashBytes(const char *p, std::size_t n) {
+		std::uint64_t h = 0x9e3779b97f4a7c15ull ^ (n * 0xff51afd7ed558ccdull);
+		auto mix = [&h](std::uint64_t w) {
+			h = (h ^ w) * 0xff51afd7ed558ccdull;
+			h ^= h >> 29;
+		};
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			std::uint64_t w;
+			std::memcpy(&w, p + i, 8);
+			mix(w);
+		}
+		std::uint64_t tail = 0;
+		std::memcpy(&tail, p + i, n - i);
+		mix(tail);
+		return h ^ (h >> 32);
+	}
+
+	// Fixed-size header at the start of a mesh cache file. The vertex data (vertexCount * stride
+	// 4-byte words, in whatever layout the owner assigned the id `layout` to) follows it, then the
+	// index buffer (indexCount unsigned ints); both are 4-byte aligned in the file and in the
+	// mapping, so they can be handed to the GPU as they are. Bounds are those of the positions
+	// before any quantization. The file is native-endian; byteOrder catches a cache copied from
+	// a foreign machine.
+	struct meshCacheHeader {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t byteOrder;
+		std::uint32_t stride; // 4-byte words per vertex
+		std::uint32_t layout;
+		std::uint64_t sourceSize;
+		std::uint64_t sourceHash;
+		std::uint64_t vertexCount;
+		std::uint64_t indexCount;
+		float boundsMin[3], boundsMax[3];
+	};
+
+	// A mesh cache file mapped read-only. vertices() and indices() point into the mapping and
+	// stay valid as long as this object does.
+	class meshCache {
+		mappedFile file;
+		const meshCacheHeader *head = nullptr;
+
+	public:
+		static constexpr char magic[8] = { 'J', 'D', 'E', 'V', 'M', 'S', 'H', '\0' };
+		static constexpr std::uint32_t version = 2;
+		static constexpr std::uint32_t byteOrder = 0x01020304;
+
+		meshCache() = default;
+
+		// Maps path and checks it against the source it was built from (size and content hash)
+		// and the expected vertex layout and stride. Anything missing, truncated, of another
+		// version or stale leaves the object empty; operator bool tells which. The indices are
+		// checked once here against the vertex count, so a corrupt file cannot index past the
+		// vertex buffer on the GPU.
+		meshCache(const std::string &path, std::uint64_t sourceSize, std::uint64_t sourceHash, std::uint32_t layout,
+		          std::uint32_t stride)
+		    : file(path) {
+			if (!file || file.size() < sizeof(meshCacheHeader)) return;
+			const auto *h = reinterpret_cast<const meshCacheHeader *>(file.data());
+			if (std::memcmp(h->magic, magic, sizeof magic) != 0 || h->version != version || h->byteOrder != byteOrder ||
+			    h->layout != layout || h->stride != stride || h->sourceSize != sourceSize ||
+			    h->sourceHash != sourceHash)
+				return;
+			const std::uint64_t payload = (h->vertexCount * h->stride) * 4 + h->indexCount * sizeof(unsigned);
+			if (h->vertexCount > file.size() || h->indexCount > file.size() ||
+			    file.size() - sizeof(meshCacheHeader) != payload)
+				return;
+			const auto *idx = reinterpret_cast<const unsigned *>(file.data() + sizeof(meshCacheHeader) +
+			                                                     std::size_t(h->vertexCount * h->stride) * 4);
+			if (h->indexCount && *std::max_element(idx, idx + h->indexCount) >= h->vertexCount) return;
+			head = h;
+		}
+
+		explicit operator bool() const { return head != nullptr; }
+
+		const meshCacheHeader &header() const { return *head; }
+		const void *vertices() const { return file.data() + sizeof(meshCacheHeader); }
+		std::size_t vertexBytes() const { return std::size_t(head->vertexCount * head->stride) * 4; }
+		const unsigned *indices() const {
+			return reinterpret_cast<const unsigned *>(file.data() + sizeof(meshCacheHeader) + vertexBytes());
+		}
+		std::size_t indexCount() const { return std::size_t(head->indexCount); }
+
+		// Writes a cache for the given source next to it; bounds are 3 floats each. The file is
+		// written under a temporary name and renamed into place, so a crash never leaves a
+		// half-written cache behind. Returns false if it could not be written; callers can carry
+		// on without a cache.
+		static bool write(const std::string &path, std::uint64_t sourceSize, std::uint64_t sourceHash,
+		                  std::uint32_t layout, std::uint32_t stride, const void *vertexData, std::size_t vertexCount,
+		                  const std::vector<unsigned> &idx, const float *boundsMin, const float *boundsMax) {
+			meshCacheHeader h{};
+			std::memcpy(h.magic, magic, sizeof magic);
+			h.version = version;
+			h.byteOrder = byteOrder;
+			h.stride = stride;
+			h.layout = layout;
+			h.sourceSize = sourceSize;
+			h.sourceHash = sourceHash;
+			h.vertexCount = vertexCount;
+			h.indexCount = idx.size();
+			std::memcpy(h.boundsMin, boundsMin, sizeof h.boundsMin);
+			std::memcpy(h.boundsMax, boundsMax, sizeof h.boundsMax);
+
+			const std::string temp = path + ".tmp";
+			{
+				std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+				if (!out) return false;
+				out.write(reinterpret_cast<const char *>(&h), sizeof h);
+				out.write(static_cast<const char *>(vertexData), std::streamsize(vertexCount * stride * 4));
+				out.write(reinterpret_cast<const char *>(idx.data()), std::streamsize(idx.size() * sizeof(unsigned)));
+				if (!out.flush()) {
+					out.close();
+					std::remove(temp.c_str());
+					return false;
+				}
+			}
+			std::remove(path.c_str()); // rename does not replace on Windows
+			if (std::rename(temp.c_str(), path.c_str()) != 0) {
+				std::remove(temp.c_str());
+				return false;
+			}
+			return true;
+		}
+	};
+}
+
+#endif
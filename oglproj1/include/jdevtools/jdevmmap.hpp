@@ -0,0 +1,138 @@
+#ifndef JDEVTOOLS_JDEVMMAP_HPP
+#define JDEVTOOLS_JDEVMMAP_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace jdevtools {
+	// Read-only memory mapping of a whole file.
+	// begin()/end() are plain const char*, so parsers (json::parse through nlohmann's contiguous
+	// input adapter, loadObj) read straight from the page cache without copying the file into a
+	// buffer or going through a stream.
+	// cpp_rl_agent2 and oglproj1 build on their own, so each carries this header; the two copies
+	// are identical and a change to one goes into the other.
+	// A file that cannot be opened leaves the object empty (operator bool is false), the same way
+	// an ifstream would; a file that opens but cannot be mapped throws std::runtime_error.
+	class mappedFile {
+		const char *first = nullptr;
+		std::size_t length = 0;
+		bool opened = false;
+#if defined(_WIN32)
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#endif
+
+		void close() noexcept {
+#if defined(_WIN32)
+			if (first) UnmapViewOfFile(first);
+			if (mapping) CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+			mapping = nullptr;
+			file = INVALID_HANDLE_VALUE;
+#else
+			if (first) munmap(const_cast<char *>(first), length);
+#endif
+			first = nullptr;
+			length = 0;
+			opened = false;
+		}
+
+	public:
+		mappedFile() = default;
+
+		explicit mappedFile(const std::string &path) {
+#if defined(_WIN32)
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return;
+			opened = true;
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size)) {
+				close();
+				throw std::runtime_error("mappedFile: cannot stat " + path);
+			}
+			length = static_cast<std::size_t>(size.QuadPart);
+			// CreateFileMapping refuses empty files; an empty range is what the caller wants anyway.
+			if (length == 0) return;
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping) first = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (!first) {
+				close();
+				throw std::runtime_error("mappedFile: cannot map " + path);
+			}
+#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) return;
+			opened = true;
+			struct stat st;
+			if (::fstat(fd, &st) != 0) {
+				::close(fd);
+				throw std::runtime_error("mappedFile: cannot stat " + path);
+			}
+			length = static_cast<std::size_t>(st.st_size);
+			// mmap refuses zero-length mappings; an empty range is what the caller wants anyway.
+			if (length == 0) {
+				::close(fd);
+				return;
+			}
+			void *p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (p == MAP_FAILED) {
+				length = 0;
+				opened = false;
+				throw std::runtime_error("mappedFile: cannot map " + path);
+			}
+			::madvise(p, length, MADV_SEQUENTIAL);
+			first = static_cast<const char *>(p);
+#endif
+		}
+
+		mappedFile(const mappedFile &) = delete;
+		mappedFile &operator=(const mappedFile &) = delete;
+
+		mappedFile(mappedFile &&other) noexcept { *this = std::move(other); }
+		mappedFile &operator=(mappedFile &&other) noexcept {
+			if (this != &other) {
+				close();
+				std::swap(first, other.first);
+				std::swap(length, other.length);
+				std::swap(opened, other.opened);
+#if defined(_WIN32)
+				std::swap(file, other.file);
+				std::swap(mapping, other.mapping);
+#endif
+			}
+			return *this;
+		}
+
+		~mappedFile() { close(); }
+
+		explicit operator bool() const { return opened; }
+
+		const char *data() const { return first; }
+		std::size_t size() const { return length; }
+		bool empty() const { return length == 0; }
+
+		const char *begin() const { return first; }
+		const char *end() const { return first + length; }
+	};
+}
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef JDEVTOOLS_JDEVMOTION_HPP
+#define JDEVTOOLS_JDEVMOTION_HPP
+
+#include "jdevtools/jdevpool.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JDEVTOOLS_MOTION_SSE 1
+#endif
+
+namespace jdevtools {
+	// Maps the fraction of a curve's length travelled to the curve parameter, both in [0, 1], so
+	// that advancing the fraction evenly moves along the curve at constant speed. Built once by
+	// sampling the curve densely and inverting the cumulative length into a uniform-resolution
+	// table; a lookup is then one linear interpolation between two entries.
+	class arcLengthTable {
+		std::vector<float> params; // params[i]: parameter at length fraction i / (size - 1)
+		float total = 0;
+
+	public:
+		// position(u) for u in [0, 1]; pieces is the number of spline segments, each sampled
+		// samplesPerPiece times and given entriesPerPiece table entries.
+		template <typename Curve>
+		void build(Curve &&position, std::size_t pieces, std::size_t samplesPerPiece = 256,
+		           std::size_t entriesPerPiece = 128) {
+			params.clear();
+			total = 0;
+			if (pieces == 0) return;
+			const std::size_t samples = pieces * samplesPerPiece;
+			std::vector<float> length(samples + 1, 0.0f);
+			glm::vec3 previous = position(0.0f);
+			for (std::size_t j = 1; j <= samples; ++j) {
+				glm::vec3 p = position(float(j) / float(samples));
+				length[j] = length[j - 1] + glm::length(p - previous);
+				previous = p;
+			}
+			total = length[samples];
+			const std::size_t entries = pieces * entriesPerPiece + 1;
+			params.resize(entries);
+			std::size_t j = 0;
+			for (std::size_t r = 0; r < entries; ++r) {
+				const float target = total * float(r) / float(entries - 1);
+				while (j + 1 < samples && length[j + 1] < target) ++j;
+				const float span = length[j + 1] - length[j];
+				const float within = span > 0 ? std::min(std::max((target - length[j]) / span, 0.0f), 1.0f) : 0.0f;
+				params[r] = (float(j) + within) / float(samples);
+			}
+			params.back() = 1.0f;
+		}
+
+		bool empty() const { return params.empty(); }
+		float length() const { return total; }
+
+		// curve parameter at the given fraction of the length; the fraction itself if not built
+		float parameterAt(float fraction) const {
+			if (params.size() < 2 || total <= 0) return fraction;
+			const float x = std::min(std::max(fraction, 0.0f), 1.0f) * float(params.size() - 1);
+			const std::size_t i = std::min(std::size_t(x), params.size() - 2);
+			return params[i] + (x - float(i)) * (params[i + 1] - params[i]);
+		}
+	};
+
+	// One keyframed motion path (cubic position spline plus slerped orientation) baked for
+	// evaluating many objects at different times in one go. Every segment between two keys is
+	// stored structure-of-arrays: the position as a cubic polynomial per axis, the orientation as
+	// its two end quaternions (the second already flipped onto the short arc) with the angle
+	// between them. evaluate() then runs four objects per SSE lane set, so per object there is
+	// no clamping of neighbour indices, no control-point copies and no 4x4 multiply.
+	// Results match MotionController::getTransform with quaternion orientation to float rounding.
+	class motionBatch {
+	public:
+		enum spline { catmullRom, bSpline };
+
+	private:
+		// poly[term * 3 + axis][segment]: position = poly0 + poly1 u + poly2 u^2 + poly3 u^3
+		std::vector<float> poly[12];
+		// from[c][segment], to[c][segment] with c = w, x, y, z
+		std::vector<float> from[4], to[4];
+		// slerp weights are sin((1 - u) angle) * invSin and sin(u angle) * invSin; invSin is 0
+		// where the ends are too close and glm falls back to a linear mix
+		std::vector<float> angle, invSin;
+		std::size_t segments = 0;
+		glm::vec3 fixedPos = glm::vec3(0);
+		glm::quat fixedRot = glm::quat(1, 0, 0, 0);
+
+		// sin on [0, pi/2] (all that slerp on the short arc needs), odd polynomial to x^11
+		static float sinQuarter(float x) {
+			float x2 = x * x;
+			const float tail = 1.0f / 120 + x2 * (-1.0f / 5040 + x2 * (1.0f / 362880 + x2 * (-1.0f / 39916800)));
+			return x * (1 + x2 * (-1.0f / 6 + x2 * tail));
+		}
+
+		static void write(float tx, float ty, float tz, float w, float x, float y, float z, glm::mat4 &model,
+		                  glm::mat3 &normal) {
+			glm::mat3 r;
+			r[0][0] = 1 - 2 * (y * y + z * z), r[0][1] = 2 * (x * y + w * z), r[0][2] = 2 * (x * z - w * y);
+			r[1][0] = 2 * (x * y - w * z), r[1][1] = 1 - 2 * (x * x + z * z), r[1][2] = 2 * (y * z + w * x);
+			r[2][0] = 2 * (x * z + w * y), r[2][1] = 2 * (y * z - w * x), r[2][2] = 1 - 2 * (x * x + y * y);
+			model = glm::mat4(r);
+			model[3] = glm::vec4(tx, ty, tz, 1);
+			normal = r;
+		}
+
+		void evaluateScalar(float t, const glm::vec3 &offset, glm::mat4 &model, glm::mat3 &normal) const {
+			if (segments == 0) {
+				glm::vec3 p = fixedPos + offset;
+				write(p.x, p.y, p.z, fixedRot.w, fixedRot.x, fixedRot.y, fixedRot.z, model, normal);
+				return;
+			}
+			float ft = t * float(segments);
+			std::size_t s = std::size_t(std::min(std::max(float(int(ft)), 0.0f), float(segments - 1)));
+			float u = ft - float(s);
+			float p[3];
+			for (int a = 0; a < 3; ++a)
+				p[a] = poly[a][s] + u * (poly[3 + a][s] + u * (poly[6 + a][s] + u * poly[9 + a][s]));
+			float w0 = 1 - u, w1 = u;
+			if (invSin[s] != 0) {
+				w0 = sinQuarter((1 - u) * angle[s]) * invSin[s];
+				w1 = sinQuarter(u * angle[s]) * invSin[s];
+			}
+			float q[4];
+			for (int c = 0; c < 4; ++c) q[c] = w0 * from[c][s] + w1 * to[c][s];
+			write(p[0] + offset.x, p[1] + offset.y, p[2] + offset.z, q[0], q[1], q[2], q[3], model, normal);
+		}
+
+#ifdef JDEVTOOLS_MOTION_SSE
+		static __m128 sinQuarter(__m128 x) {
+			const __m128 x2 = _mm_mul_ps(x, x);
+			__m128 r = _mm_set1_ps(-1.0f / 39916800);
+			r = _mm_add_ps(_mm_mul_ps(r, x2), _mm_set1_ps(1.0f / 362880));
+			r = _mm_add_ps(_mm_mul_ps(r, x2), _mm_set1_ps(-1.0f / 5040));
+			r = _mm_add_ps(_mm_mul_ps(r, x2), _mm_set1_ps(1.0f / 120));
+			r = _mm_add_ps(_mm_mul_ps(r, x2), _mm_set1_ps(-1.0f / 6));
+			r = _mm_add_ps(_mm_mul_ps(r, x2), _mm_set1_ps(1.0f));
+			return _mm_mul_ps(r, x);
+		}
+
+		static __m128 gather(const std::vector<float> &v, const int *s) {
+			return _mm_setr_ps(v[s[0]], v[s[1]], v[s[2]], v[s[3]]);
+		}
+
+		// four objects starting at t[0]; offsets may be null
+		template <typename Out>
+		void evaluate4(const float *t, const glm::vec3 *offsets, Out &&out) const {
+			const __m128 ft = _mm_mul_ps(_mm_loadu_ps(t), _mm_set1_ps(float(segments)));
+			__m128 fs = _mm_cvtepi32_ps(_mm_cvttps_epi32(ft));
+			fs = _mm_min_ps(_mm_max_ps(fs, _mm_setzero_ps()), _mm_set1_ps(float(segments - 1)));
+			const __m128 u = _mm_sub_ps(ft, fs);
+			alignas(16) int s[4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(s), _mm_cvttps_epi32(fs));
+
+			__m128 p[3];
+			for (int a = 0; a < 3; ++a) {
+				__m128 r = gather(poly[9 + a], s);
+				r = _mm_add_ps(_mm_mul_ps(r, u), gather(poly[6 + a], s));
+				r = _mm_add_ps(_mm_mul_ps(r, u), gather(poly[3 + a], s));
+				p[a] = _mm_add_ps(_mm_mul_ps(r, u), gather(poly[a], s));
+			}
+			if (offsets)
+				for (int a = 0; a < 3; ++a)
+					p[a] = _mm_add_ps(p[a], _mm_setr_ps(offsets[0][a], offsets[1][a], offsets[2][a], offsets[3][a]));
+
+			const __m128 one = _mm_set1_ps(1.0f), v = _mm_sub_ps(one, u);
+			const __m128 theta = gather(angle, s), inv = gather(invSin, s);
+			const __m128 slerp = _mm_cmpneq_ps(inv, _mm_setzero_ps());
+			const __m128 w0 = _mm_or_ps(_mm_and_ps(slerp, _mm_mul_ps(sinQuarter(_mm_mul_ps(v, theta)), inv)),
+			                            _mm_andnot_ps(slerp, v));
+			const __m128 w1 = _mm_or_ps(_mm_and_ps(slerp, _mm_mul_ps(sinQuarter(_mm_mul_ps(u, theta)), inv)),
+			                            _mm_andnot_ps(slerp, u));
+			__m128 q[4];
+			for (int c = 0; c < 4; ++c)
+				q[c] = _mm_add_ps(_mm_mul_ps(w0, gather(from[c], s)), _mm_mul_ps(w1, gather(to[c], s)));
+
+			const __m128 two = _mm_set1_ps(2.0f), w = q[0], x = q[1], y = q[2], z = q[3];
+			const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+			// columns of the model matrix, lane-wise; transposed below into per-object columns
+			__m128 c0x = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))),
+			       c0y = _mm_mul_ps(two, _mm_add_ps(xy, wz)), c0z = _mm_mul_ps(two, _mm_sub_ps(xz, wy)),
+			       c0w = _mm_setzero_ps();
+			__m128 c1x = _mm_mul_ps(two, _mm_sub_ps(xy, wz)),
+			       c1y = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))),
+			       c1z = _mm_mul_ps(two, _mm_add_ps(yz, wx)), c1w = _mm_setzero_ps();
+			__m128 c2x = _mm_mul_ps(two, _mm_add_ps(xz, wy)), c2y = _mm_mul_ps(two, _mm_sub_ps(yz, wx)),
+			       c2z = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), c2w = _mm_setzero_ps();
+			__m128 c3x = p[0], c3y = p[1], c3z = p[2], c3w = one;
+			_MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+			_MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+			_MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+			_MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+			const __m128 col[4][4] = {
+			    {c0x, c1x, c2x, c3x}, {c0y, c1y, c2y, c3y}, {c0z, c1z, c2z, c3z}, {c0w, c1w, c2w, c3w}};
+			for (int k = 0; k < 4; ++k) out(k, col[k]);
+		}
+#endif
+
+	public:
+		// positions and rotations are the keys in order; both must have the same length
+		void build(const std::vector<glm::vec3> &positions, const std::vector<glm::quat> &rotations, spline kind) {
+			const std::size_t n = std::min(positions.size(), rotations.size());
+			segments = n < 2 ? 0 : n - 1;
+			for (auto &v : poly) v.assign(segments, 0.0f);
+			for (int c = 0; c < 4; ++c) from[c].assign(segments, 0.0f), to[c].assign(segments, 0.0f);
+			angle.assign(segments, 0.0f);
+			invSin.assign(segments, 0.0f);
+			if (n == 1) fixedPos = positions[0], fixedRot = rotations[0];
+			if (n < 2) return;
+
+			auto key = [&](long i) { return positions[std::size_t(std::min(std::max(i, 0L), long(n) - 1))]; };
+			for (std::size_t s = 0; s < segments; ++s) {
+				const glm::vec3 p0 = key(long(s) - 1), p1 = key(long(s)), p2 = key(long(s) + 1), p3 = key(long(s) + 2);
+				glm::vec3 c[4];
+				if (kind == catmullRom) {
+					c[0] = p1;
+					c[1] = 0.5f * (-p0 + p2);
+					c[2] = 0.5f * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3);
+					c[3] = 0.5f * (-p0 + 3.0f * p1 - 3.0f * p2 + p3);
+				} else {
+					c[0] = (p0 + 4.0f * p1 + p2) / 6.0f;
+					c[1] = (-3.0f * p0 + 3.0f * p2) / 6.0f;
+					c[2] = (3.0f * p0 - 6.0f * p1 + 3.0f * p2) / 6.0f;
+					// cubic term as MotionController::interpPos has it, so both give the same path
+					c[3] = (-p0 + 3.0f * p1 + 3.0f * p2 - p3) / 6.0f;
+				}
+				for (int term = 0; term < 4; ++term)
+					for (int a = 0; a < 3; ++a) poly[term * 3 + a][s] = c[term][a];
+
+				// same steps as glm::slerp: short arc, linear mix when the ends nearly coincide
+				glm::quat a = rotations[s], b = rotations[s + 1];
+				float cosTheta = glm::dot(a, b);
+				if (cosTheta < 0) b = -b, cosTheta = -cosTheta;
+				if (cosTheta <= 1 - std::numeric_limits<float>::epsilon()) {
+					angle[s] = std::acos(cosTheta);
+					invSin[s] = 1 / std::sin(angle[s]);
+				}
+				const float fa[4] = { a.w, a.x, a.y, a.z }, fb[4] = { b.w, b.x, b.y, b.z };
+				for (int k = 0; k < 4; ++k) from[k][s] = fa[k], to[k][s] = fb[k];
+			}
+		}
+
+		// Evaluates count objects at times t[i] in [0, 1], each moved by offsets[i] (may be null),
+		// writing translation * rotation into *model and the rotation (its own inverse transpose)
+		// into *normal; both pointers advance by stride bytes per object, so they can point into an
+		// array of per-instance structs. With a pool, ranges of at least minPerThread objects are
+		// spread over its threads; without one everything runs on the calling thread.
+		void evaluate(const float *t, const glm::vec3 *offsets, std::size_t count, glm::mat4 *model, glm::mat3 *normal,
+			std::size_t stride, workerPool *pool = nullptr, std::size_t minPerThread = 4096) const {
+			auto at = [stride](auto *base, std::size_t i) {
+				using T = std::remove_pointer_t<decltype(base)>;
+				return reinterpret_cast<T *>(reinterpret_cast<char *>(base) + i * stride);
+			};
+			auto range = [&](std::size_t first, std::size_t last) {
+				std::size_t i = first;
+#ifdef JDEVTOOLS_MOTION_SSE
+				if (segments > 0)
+					for (; i + 4 <= last; i += 4)
+						evaluate4(t + i, offsets ? offsets + i : nullptr, [&](int k, const __m128 *col) {
+							float *m = glm::value_ptr(*at(model, i + k));
+							float *r = glm::value_ptr(*at(normal, i + k));
+							alignas(16) float c[4];
+							for (int j = 0; j < 4; ++j) _mm_storeu_ps(m + 4 * j, col[j]);
+							for (int j = 0; j < 3; ++j) {
+								_mm_store_ps(c, col[j]);
+								std::memcpy(r + 3 * j, c, 3 * sizeof(float));
+							}
+						});
+#endif
+				for (; i < last; ++i)
+					evaluateScalar(t[i], offsets ? offsets[i] : glm::vec3(0), *at(model, i), *at(normal, i));
+			};
+
+			const std::size_t threads = pool ? pool->size() : 1;
+			const std::size_t perThread = std::max<std::size_t>(minPerThread, 1);
+			std::size_t parts = std::min<std::size_t>(threads, std::max<std::size_t>(1, count / perThread));
+			const std::size_t per = (count / parts + 3) & ~std::size_t(3);
+			if (parts == 1) range(0, count);
+			else
+				pool->run((count + per - 1) / per,
+				          [&](std::size_t p) { range(p * per, std::min(count, (p + 1) * per)); });
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef JDEVTOOLS_JDEVOBJ_HPP
+#define JDEVTOOLS_JDEVOBJ_HPP
+
+#include "jdevtools/jdevmmap.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jdevtools {
+	// Positions, normals and per-corner indices of a Wavefront OBJ file. Every face contributes
+	// its first three corners, as Model::load always did; a corner without a normal index reuses
+	// its position index.
+	struct objMesh {
+		std::vector<glm::vec3> positions, normals;
+		std::vector<unsigned> positionIndex, normalIndex;
+	};
+
+	namespace objDetail {
+		// Corner indices are stored 0-based when absolute. Negative (relative) OBJ indices become
+		// relative + k, k being the 0-based index counted from the chunk's first record (negative
+		// when it points into an earlier chunk), and are rebased on merge.
+		static constexpr std::int64_t noNormal = std::numeric_limits<std::int64_t>::min();
+		static constexpr std::int64_t relative = -(std::int64_t(1) << 62);
+
+		struct chunk {
+			std::vector<glm::vec3> positions, normals;
+			std::vector<std::int64_t> positionIndex, normalIndex;
+			bool failed = false;
+		};
+
+		inline const char *skipBlanks(const char *p, const char *end) {
+			while (p < end && (*p == ' ' || *p == '\t')) ++p;
+			return p;
+		}
+
+		inline bool parseFloat(const char *&p, const char *end, float &out) {
+			p = skipBlanks(p, end);
+			if (p < end && *p == '+') ++p;
+			auto [next, ec] = std::from_chars(p, end, out);
+			if (ec == std::errc::invalid_argument) return false;
+			// too small or too large for a float: strtof gives 0, a denormal or +-inf, as the
+			// stream-based parser did, instead of failing the whole model
+			if (ec == std::errc::result_out_of_range) out = std::strtof(std::string(p, next).c_str(), nullptr);
+			p = next;
+			return true;
+		}
+
+		inline bool parseInt(const char *&p, const char *end, std::int64_t &out) {
+			bool negative = false;
+			if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+			if (p == end || *p < '0' || *p > '9') return false;
+			std::int64_t v = 0;
+			while (p < end && *p >= '0' && *p <= '9' && v < (std::int64_t(1) << 40)) v = v * 10 + (*p++ - '0');
+			out = negative ? -v : v;
+			return true;
+		}
+
+		// OBJ index (1-based, or negative from the end of what is defined so far) to the stored form
+		inline bool corner(std::int64_t objIndex, std::size_t defined, std::int64_t &out) {
+			if (objIndex == 0) return false;
+			out = objIndex > 0 ? objIndex - 1 : relative + std::int64_t(defined) + objIndex;
+			return true;
+		}
+
+		inline bool parseFace(const char *p, const char *end, chunk &c) {
+			for (int i = 0; i < 3; ++i) {
+				p = skipBlanks(p, end);
+				std::int64_t v, n = noNormal, stored;
+				if (!parseInt(p, end, v) || !corner(v, c.positions.size(), stored)) return false;
+				c.positionIndex.push_back(stored);
+				if (p < end && *p == '/') {
+					++p;
+					if (p < end && *p != '/') {
+						std::int64_t ignoredTexture;
+						if (p < end && *p != ' ' && *p != '\t' && !parseInt(p, end, ignoredTexture)) return false;
+					}
+					if (p < end && *p == '/') {
+						++p;
+						if (p < end && *p != ' ' && *p != '\t') {
+							std::int64_t objNormal;
+							if (!parseInt(p, end, objNormal) || !corner(objNormal, c.normals.size(), n)) return false;
+						}
+					}
+				}
+				c.normalIndex.push_back(n);
+				while (p < end && *p != ' ' && *p != '\t') ++p;
+			}
+			return true;
+		}
+
+		// Parses whole lines in [p, end).
+		inline void parseLines(const char *p, const char *end, chunk &c) {
+			while (p < end && !c.failed) {
+				const char *eol = static_cast<const char *>(std::memchr(p, '\n', std::size_t(end - p)));
+				if (!eol) eol = end;
+				const char *lineEnd = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+				const char *q = skipBlanks(p, lineEnd);
+				if (lineEnd - q > 1) {
+					if (q[0] == 'v' && (q[1] == ' ' || q[1] == '\t')) {
+						glm::vec3 v;
+						q += 1;
+						c.failed = !parseFloat(q, lineEnd, v.x) || !parseFloat(q, lineEnd, v.y) ||
+						           !parseFloat(q, lineEnd, v.z);
+						c.positions.push_back(v);
+					} else if (q[0] == 'v' && q[1] == 'n' && lineEnd - q > 2 && (q[2] == ' ' || q[2] == '\t')) {
+						glm::vec3 n;
+						q += 2;
+						c.failed = !parseFloat(q, lineEnd, n.x) || !parseFloat(q, lineEnd, n.y) ||
+						           !parseFloat(q, lineEnd, n.z);
+						c.normals.push_back(n);
+					} else if (q[0] == 'f' && (q[1] == ' ' || q[1] == '\t')) {
+						c.failed = !parseFace(q + 1, lineEnd, c);
+					}
+				}
+				p = eol + 1;
+			}
+		}
+
+		inline bool resolve(std::int64_t stored, std::size_t base, std::size_t count, unsigned &out) {
+			std::int64_t index = stored >= 0 ? stored : std::int64_t(base) + (stored - relative);
+			if (index < 0 || std::uint64_t(index) >= count ||
+			    std::uint64_t(index) > std::numeric_limits<unsigned>::max())
+				return false;
+			out = unsigned(index);
+			return true;
+		}
+	}
+
+	// Loads the v, vn and f records of OBJ text in [first, last). The text is cut at line
+	// boundaries into one chunk per thread; chunks are parsed in parallel, then copied into place
+	// with relative indices rebased, again one thread per chunk. Text under minBytes is parsed on
+	// the calling thread. Returns false if a v/vn/f record is malformed or a face refers to a
+	// vertex that does not exist.
+	inline bool loadObj(const char *first, const char *last, objMesh &out, unsigned threads = 0,
+	                    std::size_t minBytes = 1 << 20) {
+		const std::size_t size = std::size_t(last - first);
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		if (size < minBytes) threads = 1;
+
+		// chunk boundaries just after a newline
+		std::vector<const char *> cuts = { first };
+		for (unsigned t = 1; t < threads; ++t) {
+			const char *at = std::max(cuts.back(), first + size / threads * t);
+			const char *eol =
+			    at < last ? static_cast<const char *>(std::memchr(at, '\n', std::size_t(last - at))) : nullptr;
+			if (!eol) break;
+			cuts.push_back(eol + 1);
+		}
+		cuts.push_back(last);
+		const std::size_t chunks = cuts.size() - 1;
+
+		std::vector<objDetail::chunk> parts(chunks);
+		auto runAll = [&](auto &&job) {
+			std::vector<std::thread> workers;
+			for (std::size_t i = 1; i < chunks; ++i) workers.emplace_back(job, i);
+			job(0);
+			for (std::thread &w : workers) w.join();
+		};
+		runAll([&](std::size_t i) { objDetail::parseLines(cuts[i], cuts[i + 1], parts[i]); });
+
+		std::vector<std::size_t> positionBase(chunks + 1, 0), normalBase(chunks + 1, 0), cornerBase(chunks + 1, 0);
+		for (std::size_t i = 0; i < chunks; ++i) {
+			if (parts[i].failed) return false;
+			positionBase[i + 1] = positionBase[i] + parts[i].positions.size();
+			normalBase[i + 1] = normalBase[i] + parts[i].normals.size();
+			cornerBase[i + 1] = cornerBase[i] + parts[i].positionIndex.size();
+		}
+		out.positions.resize(positionBase[chunks]);
+		out.normals.resize(normalBase[chunks]);
+		out.positionIndex.resize(cornerBase[chunks]);
+		out.normalIndex.resize(cornerBase[chunks]);
+
+		std::vector<char> bad(chunks, 0);
+		runAll([&](std::size_t i) {
+			const objDetail::chunk &c = parts[i];
+			std::copy(c.positions.begin(), c.positions.end(), out.positions.begin() + positionBase[i]);
+			std::copy(c.normals.begin(), c.normals.end(), out.normals.begin() + normalBase[i]);
+			for (std::size_t k = 0; k < c.positionIndex.size(); ++k) {
+				unsigned &v = out.positionIndex[cornerBase[i] + k];
+				unsigned &n = out.normalIndex[cornerBase[i] + k];
+				if (!objDetail::resolve(c.positionIndex[k], positionBase[i], out.positions.size(), v)) bad[i] = 1;
+				// normals may be out of range; Model::load falls back to a computed normal then
+				if (c.normalIndex[k] == objDetail::noNormal) n = v;
+				else if (!objDetail::resolve(c.normalIndex[k], normalBase[i], std::numeric_limits<std::size_t>::max(),
+				                             n))
+					n = std::numeric_limits<unsigned>::max();
+			}
+		});
+		return std::find(bad.begin(), bad.end(), 1) == bad.end();
+	}
+
+	// Same, for a file, which is memory-mapped; also false if the file cannot be opened.
+	inline bool loadObj(const std::string &path, objMesh &out, unsigned threads = 0, std::size_t minBytes = 1 << 20) {
+		mappedFile file(path);
+		if (!file) return false;
+		return loadObj(file.begin(), file.end(), out, threads, minBytes);
+	}
+}
+
+#endif
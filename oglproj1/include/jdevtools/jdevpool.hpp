@@ -0,0 +1,91 @@
+#ifndef JDEVTOOLS_JDEVPOOL_HPP
+#define JDEVTOOLS_JDEVPOOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jdevtools {
+	// Fixed set of threads for fork-join work that recurs every frame: the threads are started
+	// once and sleep between run() calls, so a frame pays a wake-up instead of a thread spawn
+	// and join per part. One run() at a time; jobs must not throw.
+	class workerPool {
+		std::vector<std::thread> threads;
+		std::mutex lock;
+		std::condition_variable wake, done;
+		void (*invoke)(void *, std::size_t) = nullptr;
+		void *job = nullptr;
+		std::size_t next = 0, parts = 0, pending = 0;
+		bool stopping = false;
+
+		void loop() {
+			std::unique_lock<std::mutex> guard(lock);
+			for (;;) {
+				wake.wait(guard, [this] { return stopping || next < parts; });
+				if (stopping) return;
+				const std::size_t part = next++;
+				guard.unlock();
+				invoke(job, part);
+				guard.lock();
+				if (--pending == 0) done.notify_one();
+			}
+		}
+
+	public:
+		// workers threads besides the caller's (0: one per hardware thread, less the caller's)
+		explicit workerPool(unsigned workers = 0) {
+			if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+			for (unsigned i = 0; i < workers; ++i) threads.emplace_back([this] { loop(); });
+		}
+		workerPool(const workerPool &) = delete;
+		workerPool &operator=(const workerPool &) = delete;
+		~workerPool() {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (std::thread &t : threads) t.join();
+		}
+
+		// threads that run() spreads parts over, the caller's included
+		std::size_t size() const { return threads.size() + 1; }
+
+		// Calls fn(0) .. fn(count - 1) and returns once all have finished. Part 0 runs on the
+		// calling thread, which then takes any part no worker has picked up yet.
+		template <typename Fn>
+		void run(std::size_t count, Fn &&fn) {
+			if (count == 0) return;
+			if (count == 1 || threads.empty()) {
+				for (std::size_t part = 0; part < count; ++part) fn(part);
+				return;
+			}
+			using F = std::remove_reference_t<Fn>;
+			std::unique_lock<std::mutex> guard(lock);
+			invoke = [](void *f, std::size_t part) { (*static_cast<F *>(f))(part); };
+			job = const_cast<void *>(static_cast<const void *>(&fn));
+			next = 1;
+			parts = count;
+			pending = count - 1;
+			guard.unlock();
+			wake.notify_all();
+
+			fn(0);
+			guard.lock();
+			while (next < parts) {
+				const std::size_t part = next++;
+				guard.unlock();
+				fn(part);
+				guard.lock();
+				--pending;
+			}
+			done.wait(guard, [this] { return pending == 0; });
+		}
+	};
+}
+
+#endif
@@ -5,12 +5,21 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <jdevtools/jdevmesh.hpp>
+#include <jdevtools/jdevmeshcache.hpp>
+#include <jdevtools/jdevmotion.hpp>
+#include <jdevtools/jdevobj.hpp>
+#include <jdevtools/jdevpool.hpp>
 
-#include <chrono>
-#include <fstream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
-#include <sstream>
+#include <string_view>
 #include <vector>
 
 // Shader sources
@@ -18,12 +27,17 @@ const char *vsSrc = R"(
 #version 330 core
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNormal;
-uniform mat4 model, view, projection;
-uniform mat3 normalMatrix;
+layout(location=2) in mat4 iModel;        // per instance
+layout(location=6) in mat3 iNormalMatrix; // per instance
+layout(std140) uniform Camera {
+    mat4 view, projection;
+    vec3 viewPos;
+};
+uniform vec3 posOffset, posScale;
 out vec3 FragPos, Normal;
 void main() {
-    FragPos = vec3(model * vec4(aPos,1.0));
-    Normal = normalMatrix * aNormal;
+    FragPos = vec3(iModel * vec4(posOffset + aPos * posScale,1.0));
+    Normal = iNormalMatrix * aNormal;
     gl_Position = projection * view * vec4(FragPos,1.0);
 }
 )";
@@ -31,10 +45,17 @@ const char *fsSrc = R"(
 #version 330 core
 out vec4 FragColor;
 in vec3 FragPos, Normal;
-uniform vec3 lightPos, lightAmbient, lightDiffuse, lightSpecular;
-uniform vec3 materialAmbient, materialDiffuse, materialSpecular, materialEmission;
-uniform float materialShininess;
-uniform vec3 viewPos;
+layout(std140) uniform Camera {
+    mat4 view, projection;
+    vec3 viewPos;
+};
+layout(std140) uniform Light {
+    vec3 lightPos, lightAmbient, lightDiffuse, lightSpecular;
+};
+layout(std140) uniform Material {
+    vec3 materialAmbient, materialDiffuse, materialSpecular, materialEmission;
+    float materialShininess;
+};
 void main() {
     vec3 norm = normalize(Normal);
     vec3 lightDir = normalize(lightPos - FragPos);
@@ -49,9 +70,30 @@ void main() {
 }
 )";
 
+// Uniform names are hashed at compile time: any string literal passed to Shader::set becomes
+// a UniformName without a strlen or a hash at run time.
+constexpr uint32_t uniformHash(std::string_view s) {
+	uint32_t h = 2166136261u;
+	for (char c : s) h = (h ^ uint8_t(c)) * 16777619u;
+	return h;
+}
+struct UniformName {
+	uint32_t hash;
+	const char *name;
+	consteval UniformName(const char *s) : hash(uniformHash(s)), name(s) {}
+};
+
+// Binding points of the uniform blocks shared by all shaders
+enum UniformBinding : unsigned {
+	CameraBinding = 0,
+	LightBinding = 1,
+	MaterialBinding = 2
+};
+
 // Shader class
 struct Shader {
 	unsigned int ID;
+	std::vector<std::pair<uint32_t, int>> locations; // (name hash, location), sorted; filled at link time
 	Shader(const char *vs, const char *fs) {
 		auto compile = [](const char *src, GLenum type) {
 			unsigned int s = glCreateShader(type);
@@ -80,49 +122,207 @@ struct Shader {
 		}
 		glDeleteShader(v);
 		glDeleteShader(f);
+		reflect();
+		bindBlock("Camera", CameraBinding);
+		bindBlock("Light", LightBinding);
+		bindBlock("Material", MaterialBinding);
 	}
 	~Shader() { glDeleteProgram(ID); }
+	// Records the location of every active uniform outside a block, keyed by name hash.
+	void reflect() {
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		std::vector<char> name(std::max(maxLength, 1));
+		locations.clear();
+		for (GLint i = 0; i < count; ++i) {
+			GLsizei length = 0;
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(ID, GLuint(i), GLsizei(name.size()), &length, &size, &type, name.data());
+			int loc = glGetUniformLocation(ID, name.data()); // -1 for block members
+			if (loc < 0) continue;
+			std::string_view n(name.data(), length);
+			if (n.size() > 3 && n.substr(n.size() - 3) == "[0]") n.remove_suffix(3);
+			locations.emplace_back(uniformHash(n), loc);
+		}
+		std::sort(locations.begin(), locations.end());
+		for (size_t i = 1; i < locations.size(); ++i)
+			if (locations[i].first == locations[i - 1].first) std::cerr << "Uniform name hash collision\n";
+	}
+	// -1 (ignored by glUniform*) for names the program does not use
+	int location(UniformName n) const {
+		auto it = std::lower_bound(locations.begin(), locations.end(), std::pair<uint32_t, int>(n.hash, INT32_MIN));
+		return it != locations.end() && it->first == n.hash ? it->second : -1;
+	}
+	void bindBlock(const char *block, unsigned binding) const {
+		unsigned index = glGetUniformBlockIndex(ID, block);
+		if (index != GL_INVALID_INDEX) glUniformBlockBinding(ID, index, binding);
+	}
 	void use() const { glUseProgram(ID); }
-	void set(const char *n, const glm::mat4 &m) const {
-		glUniformMatrix4fv(glGetUniformLocation(ID, n), 1, GL_FALSE, glm::value_ptr(m));
+	void set(UniformName n, const glm::mat4 &m) const {
+		glUniformMatrix4fv(location(n), 1, GL_FALSE, glm::value_ptr(m));
+	}
+	void set(UniformName n, const glm::mat3 &m) const {
+		glUniformMatrix3fv(location(n), 1, GL_FALSE, glm::value_ptr(m));
+	}
+	void set(UniformName n, const glm::vec3 &v) const { glUniform3fv(location(n), 1, glm::value_ptr(v)); }
+	void set(UniformName n, float v) const { glUniform1f(location(n), v); }
+};
+
+// std140 mirrors of the shaders' uniform blocks: every vec3 starts on a 16-byte boundary, and a
+// lone float after a vec3 fills its fourth slot.
+struct CameraBlock {
+	glm::mat4 view, projection;
+	glm::vec3 viewPos;
+	float pad0;
+};
+struct LightBlock {
+	glm::vec3 pos;
+	float pad0;
+	glm::vec3 ambient;
+	float pad1;
+	glm::vec3 diffuse;
+	float pad2;
+	glm::vec3 specular;
+	float pad3;
+};
+struct MaterialBlock {
+	glm::vec3 ambient;
+	float pad0;
+	glm::vec3 diffuse;
+	float pad1;
+	glm::vec3 specular;
+	float pad2;
+	glm::vec3 emission;
+	float shininess;
+};
+static_assert(sizeof(CameraBlock) == 144 && offsetof(CameraBlock, viewPos) == 128);
+static_assert(sizeof(LightBlock) == 64 && offsetof(LightBlock, specular) == 48);
+static_assert(sizeof(MaterialBlock) == 64 && offsetof(MaterialBlock, shininess) == 60);
+
+// A uniform block in its own buffer, bound once to its binding point. edit() changes the CPU
+// copy and marks it dirty; upload() sends it to the GPU only when something changed.
+template <typename T>
+struct UniformBlock {
+	T value{};
+	unsigned UBO = 0, binding;
+	bool dirty = true;
+	explicit UniformBlock(unsigned binding) : binding(binding) {}
+	~UniformBlock() {
+		if (UBO) glDeleteBuffers(1, &UBO);
 	}
-	void set(const char *n, const glm::mat3 &m) const {
-		glUniformMatrix3fv(glGetUniformLocation(ID, n), 1, GL_FALSE, glm::value_ptr(m));
+	T &edit() {
+		dirty = true;
+		return value;
 	}
-	void set(const char *n, const glm::vec3 &v) const {
-		glUniform3fv(glGetUniformLocation(ID, n), 1, glm::value_ptr(v));
+	void upload() {
+		if (!UBO) {
+			glGenBuffers(1, &UBO);
+			glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+			glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+		}
+		if (!dirty) return;
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &value);
+		dirty = false;
 	}
-	void set(const char *n, float v) const { glUniform1f(glGetUniformLocation(ID, n), v); }
+};
+
+// Vertex layouts a Mesh can upload; the values are also what mesh caches record
+enum class VertexLayout : uint32_t {
+	Float = 0,    // position and normal as 6 floats, 24 bytes
+	Quantized = 1 // jdevtools::packedVertex, 12 bytes
+};
+
+// Per-instance data, streamed to the GPU every frame: model matrix in attributes 2-5 and
+// normal matrix in 6-8, advancing once per instance
+struct Instance {
+	glm::mat4 model;
+	glm::mat3 normal;
 };
 
 // Mesh class
 struct Mesh {
 	std::vector<float> verts;
 	std::vector<unsigned> idx;
-	unsigned VAO = 0, VBO = 0, EBO = 0;
+	VertexLayout layout = VertexLayout::Float;
+	// the vertex shader computes position = posOffset + aPos * posScale
+	glm::vec3 posOffset = glm::vec3(0), posScale = glm::vec3(1);
+	unsigned VAO = 0, VBO = 0, EBO = 0, instanceVBO = 0;
+	GLsizei count = 0, instanceCount = 0;
+	size_t instanceCapacity = 0;
+	static size_t vertexSize(VertexLayout l) {
+		return l == VertexLayout::Quantized ? sizeof(jdevtools::packedVertex) : 6 * sizeof(float);
+	}
 	~Mesh() {
 		if (VAO) glDeleteVertexArrays(1, &VAO);
 		if (VBO) glDeleteBuffers(1, &VBO);
 		if (EBO) glDeleteBuffers(1, &EBO);
+		if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
 	}
-	void setup() {
+	// Uploads vertex data already in `layout`, from anywhere, e.g. straight out of a mapped mesh
+	// cache; verts and idx are left alone. bounds are those the positions were quantized against.
+	void setup(const void *vertexData, size_t vertexBytes, const unsigned *indexData, size_t indexCount,
+	           const jdevtools::vertexBounds &bounds) {
+		count = GLsizei(indexCount);
+		posOffset = layout == VertexLayout::Quantized ? bounds.offset() : glm::vec3(0);
+		posScale = layout == VertexLayout::Quantized ? bounds.scale() : glm::vec3(1);
 		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
 		glGenBuffers(1, &EBO);
 		glBindVertexArray(VAO);
 		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData, GL_STATIC_DRAW);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)0);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned), indexData, GL_STATIC_DRAW);
+		const GLsizei stride = GLsizei(vertexSize(layout));
+		if (layout == VertexLayout::Quantized) {
+			glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+			                      (void *)offsetof(jdevtools::packedVertex, position));
+			glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride,
+			                      (void *)offsetof(jdevtools::packedVertex, normal));
+		} else {
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void *)(3 * sizeof(float)));
+		}
 		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)(3 * sizeof(float)));
 		glEnableVertexAttribArray(1);
+		glGenBuffers(1, &instanceVBO);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		for (unsigned c = 0; c < 4; ++c) {
+			glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+			                      (void *)(offsetof(Instance, model) + c * sizeof(glm::vec4)));
+			glEnableVertexAttribArray(2 + c);
+			glVertexAttribDivisor(2 + c, 1);
+		}
+		for (unsigned c = 0; c < 3; ++c) {
+			glVertexAttribPointer(6 + c, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+			                      (void *)(offsetof(Instance, normal) + c * sizeof(glm::vec3)));
+			glEnableVertexAttribArray(6 + c);
+			glVertexAttribDivisor(6 + c, 1);
+		}
 		glBindVertexArray(0);
 	}
+	// Streams this frame's instances. The buffer is orphaned rather than overwritten, so the
+	// driver never waits for the previous frame's draw to finish reading it.
+	void setInstances(const std::vector<Instance> &instances) {
+		instanceCount = GLsizei(instances.size());
+		const size_t bytes = instances.size() * sizeof(Instance);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		if (bytes > instanceCapacity) {
+			instanceCapacity = bytes;
+			glBufferData(GL_ARRAY_BUFFER, bytes, instances.data(), GL_STREAM_DRAW);
+		} else {
+			glBufferData(GL_ARRAY_BUFFER, instanceCapacity, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+		}
+	}
+	// every instance in one call
 	void draw() const {
 		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, idx.size(), GL_UNSIGNED_INT, 0);
+		glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0, instanceCount);
 		glBindVertexArray(0);
 	}
 };
@@ -130,36 +330,27 @@ struct Mesh {
 // Model loader
 struct Model {
 	Mesh mesh;
+	// A binary cache of the finished mesh, in mesh.layout, is kept next to the OBJ file
+	// (fn + ".jmesh"). While it matches the OBJ's size and content hash, it is mapped and
+	// uploaded as is and the OBJ is never parsed.
 	bool load(const std::string &fn) {
-		std::ifstream f(fn);
-		if (!f.is_open()) return false;
-		std::vector<glm::vec3> v, n;
-		std::vector<unsigned> vi, ni;
-		std::string l;
-		while (std::getline(f, l)) {
-			std::istringstream s(l);
-			std::string t;
-			s >> t;
-			if (t == "v") {
-				glm::vec3 p;
-				s >> p.x >> p.y >> p.z;
-				v.push_back(p);
-			} else if (t == "vn") {
-				glm::vec3 p;
-				s >> p.x >> p.y >> p.z;
-				n.push_back(p);
-			} else if (t == "f") {
-				for (int i = 0; i < 3; ++i) {
-					std::string w;
-					s >> w;
-					size_t p1 = w.find('/'), p2 = w.find('/', p1 + 1);
-					unsigned vi_ = std::stoi(w.substr(0, p1)) - 1, ni_ = vi_;
-					if (p2 != std::string::npos && p2 + 1 < w.size()) ni_ = std::stoi(w.substr(p2 + 1)) - 1;
-					vi.push_back(vi_);
-					ni.push_back(ni_);
-				}
-			}
+		jdevtools::mappedFile source(fn);
+		if (!source) return false;
+		const uint64_t sourceHash = jdevtools::hashBytes(source.data(), source.size());
+		const std::string cachePath = fn + ".jmesh";
+		const uint32_t layoutId = uint32_t(mesh.layout), strideWords = uint32_t(Mesh::vertexSize(mesh.layout) / 4);
+		if (jdevtools::meshCache cache{cachePath, source.size(), sourceHash, layoutId, strideWords}) {
+			jdevtools::vertexBounds bounds;
+			bounds.min = glm::make_vec3(cache.header().boundsMin);
+			bounds.max = glm::make_vec3(cache.header().boundsMax);
+			mesh.setup(cache.vertices(), cache.vertexBytes(), cache.indices(), cache.indexCount(), bounds);
+			return true;
 		}
+
+		jdevtools::objMesh obj;
+		if (!jdevtools::loadObj(source.begin(), source.end(), obj)) return false;
+		const std::vector<glm::vec3> &v = obj.positions, &n = obj.normals;
+		const std::vector<unsigned> &vi = obj.positionIndex, &ni = obj.normalIndex;
 		if (v.empty()) return false;
 		glm::vec3 min = v[0], max = v[0];
 		for (auto &p : v) {
@@ -168,16 +359,40 @@ struct Model {
 		}
 		glm::vec3 c = (min + max) * 0.5f, sz = max - min;
 		float sc = 2.0f / glm::max(sz.x, glm::max(sz.y, sz.z));
-		mesh.verts.clear();
+		// corners sharing a position and normal share one vertex
+		jdevtools::vertexWelder welder(6, v.size());
 		mesh.idx.clear();
+		mesh.idx.reserve(vi.size());
 		for (size_t i = 0; i < vi.size(); ++i) {
 			glm::vec3 p = (v[vi[i]] - c) * sc;
-			mesh.verts.insert(mesh.verts.end(), {p.x, p.y, p.z});
 			glm::vec3 norm = ni[i] < n.size() ? n[ni[i]] : glm::normalize(p);
-			mesh.verts.insert(mesh.verts.end(), {norm.x, norm.y, norm.z});
-			mesh.idx.push_back(i);
+			const float vert[6] = {p.x, p.y, p.z, norm.x, norm.y, norm.z};
+			mesh.idx.push_back(welder.add(vert));
 		}
-		mesh.setup();
+		mesh.verts = welder.release();
+		// triangle order for the post-transform cache, then overdraw, then vertex order for fetches
+		const size_t vertexCount = mesh.verts.size() / 6;
+		jdevtools::vertexCacheStats before = jdevtools::analyzeVertexCache(mesh.idx, vertexCount);
+		jdevtools::optimizeVertexCache(mesh.idx, vertexCount);
+		jdevtools::optimizeOverdraw(mesh.idx, mesh.verts, 6);
+		jdevtools::optimizeVertexFetch(mesh.verts, 6, mesh.idx);
+		jdevtools::vertexCacheStats after = jdevtools::analyzeVertexCache(mesh.idx, mesh.verts.size() / 6);
+		std::cout << fn << ": " << mesh.idx.size() / 3 << " triangles, " << mesh.verts.size() / 6 << " vertices, ACMR "
+		          << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << '\n';
+		jdevtools::vertexBounds bounds(mesh.verts, 6);
+		std::vector<jdevtools::packedVertex> packed;
+		const void *vertexData = mesh.verts.data();
+		if (mesh.layout == VertexLayout::Quantized) {
+			packed = jdevtools::quantizeVertices(mesh.verts, bounds);
+			vertexData = packed.data();
+		}
+		const size_t uniqueVertices = mesh.verts.size() / 6;
+		if (!jdevtools::meshCache::write(cachePath, source.size(), sourceHash, layoutId, strideWords, vertexData,
+		                                 uniqueVertices, mesh.idx, glm::value_ptr(bounds.min),
+		                                 glm::value_ptr(bounds.max)))
+			std::cerr << "Could not write mesh cache " << cachePath << '\n';
+		const size_t vertexBytes = uniqueVertices * Mesh::vertexSize(mesh.layout);
+		mesh.setup(vertexData, vertexBytes, mesh.idx.data(), mesh.idx.size(), bounds);
 		return true;
 	}
 	void draw() const { mesh.draw(); }
@@ -200,10 +415,42 @@ struct Keyframe {
 };
 
 class MotionController {
+	jdevtools::motionBatch batch; // keys baked for getTransforms
+	bool baked = false;
+	InterpType bakedInterp = InterpType::CatmullRom;
+	mutable jdevtools::arcLengthTable arcLength; // built on first use after the keys change
+	mutable bool arcBaked = false;
+	mutable InterpType arcInterp = InterpType::CatmullRom;
+	std::vector<float> params;
+
+	// Debug builds check a freshly baked batch against interpPos/interpQuat at times spread over
+	// the path; enough of them that the SIMD path runs, whatever the crowd size.
+	void checkBatch() const {
+		const size_t n = 67;
+		std::vector<float> t(n);
+		std::vector<glm::vec3> offsets(n, glm::vec3(0));
+		std::vector<Instance> out(n);
+		for (size_t i = 0; i < n; ++i) t[i] = float(i) / float(n - 1);
+		batch.evaluate(t.data(), offsets.data(), n, &out[0].model, &out[0].normal, sizeof(Instance));
+		float worst = 0;
+		for (size_t i = 0; i < n; ++i) {
+			glm::mat4 want = glm::translate(glm::mat4(1), interpPos(t[i])) * glm::mat4_cast(interpQuat(t[i]));
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r) worst = std::max(worst, std::abs(out[i].model[c][r] - want[c][r]));
+			for (int c = 0; c < 3; ++c)
+				for (int r = 0; r < 3; ++r) worst = std::max(worst, std::abs(out[i].normal[c][r] - want[c][r]));
+		}
+		assert(worst < 1e-3f && "motionBatch disagrees with MotionController");
+		(void)worst;
+	}
+
   public:
 	std::vector<Keyframe> keys;
 	OrientationType orientType = OrientationType::Euler;
 	InterpType interpType = InterpType::CatmullRom;
+	// t passed to getTransform(s) is the fraction of the path's length covered rather than of
+	// its keys, so the object moves at constant speed whatever the spacing of the keys
+	bool constantSpeed = false;
 
 	// Add a keyframe (Euler or Quaternion)
 	void addKey(const glm::vec3 &pos, const glm::vec3 &euler) {
@@ -212,6 +459,7 @@ class MotionController {
 		k.euler = euler;
 		k.quat = glm::quat(euler);
 		keys.push_back(k);
+		baked = arcBaked = false;
 	}
 	void addKey(const glm::vec3 &pos, const glm::quat &quat) {
 		Keyframe k;
@@ -219,6 +467,7 @@ class MotionController {
 		k.quat = quat;
 		k.euler = glm::eulerAngles(quat);
 		keys.push_back(k);
+		baked = arcBaked = false;
 	}
 
 	// Interpolate position
@@ -261,94 +510,202 @@ class MotionController {
 		}
 	}
 
+	// Spline parameter (for interpPos/interpQuat) at playback time t
+	float pathParam(float t) const {
+		if (!constantSpeed) return t;
+		if (!arcBaked || arcInterp != interpType) {
+			arcLength.build([this](float u) { return interpPos(u); }, keys.size() < 2 ? 0 : keys.size() - 1);
+			arcBaked = true;
+			arcInterp = interpType;
+		}
+		return arcLength.parameterAt(t);
+	}
+
 	// Get transform matrix at t (0..1)
 	glm::mat4 getTransform(float t) const {
+		t = pathParam(t);
 		glm::vec3 pos = interpPos(t);
 		glm::quat rot = interpQuat(t);
 		glm::mat4 T = glm::translate(glm::mat4(1), pos);
 		glm::mat4 R = glm::mat4_cast(rot);
 		return T * R;
 	}
+
+	// getTransform for count objects at times t, each translated by offsets[i], written to model
+	// and its normal matrix to normal; both advance by stride bytes. Quaternion orientation goes
+	// through the SIMD jdevtools::motionBatch, spread over pool's threads when given, baked again
+	// after keys are added or the interpolation changes; Euler orientation falls back to
+	// getTransform per object.
+	void getTransforms(const float *t, const glm::vec3 *offsets, size_t count, glm::mat4 *model, glm::mat3 *normal,
+	                   size_t stride, jdevtools::workerPool *pool = nullptr) {
+		if (orientType == OrientationType::Quaternion) {
+			if (!baked || bakedInterp != interpType) {
+				std::vector<glm::vec3> positions;
+				std::vector<glm::quat> rotations;
+				for (const Keyframe &k : keys) positions.push_back(k.position), rotations.push_back(k.quat);
+				const auto curve = interpType == InterpType::CatmullRom ? jdevtools::motionBatch::catmullRom
+				                                                        : jdevtools::motionBatch::bSpline;
+				batch.build(positions, rotations, curve);
+				baked = true;
+				bakedInterp = interpType;
+#ifndef NDEBUG
+				checkBatch();
+#endif
+			}
+			if (constantSpeed) {
+				params.resize(count);
+				for (size_t i = 0; i < count; ++i) params[i] = pathParam(t[i]);
+				t = params.data();
+			}
+			batch.evaluate(t, offsets, count, model, normal, stride, pool);
+			return;
+		}
+		for (size_t i = 0; i < count; ++i) {
+			glm::mat4 m = glm::translate(glm::mat4(1), offsets[i]) * getTransform(t[i]);
+			*(glm::mat4 *)((char *)model + i * stride) = m;
+			*(glm::mat3 *)((char *)normal + i * stride) = glm::transpose(glm::inverse(glm::mat3(m)));
+		}
+	}
 };
 
 // Globals
 int W = 600, H = 600;
 int angle = 0;
-const int FPS = 60;
-std::chrono::steady_clock::time_point lastTime;
+const int FPS = 60;                       // frames drawn per second at most
+const double tickSeconds = 1.0 / 60;      // length of one simulation step
+const double maxFrameSeconds = 0.25;      // longer stalls are not caught up on
 std::unique_ptr<Shader> shader;
 std::unique_ptr<Model> model;
-glm::mat4 modelMat = glm::mat4(1.0f);
+// models drawn, each on its own spot and at its own phase of the motion path; the first command-line
+// argument sets it, and Up / Down double and halve it while running
+int crowdSize = 1;
+const int maxCrowdSize = 1 << 16;
+std::vector<Instance> instances;
 MotionController motion;
-float motionTime = 0;
+jdevtools::workerPool workers; // for large crowds; sleeps between frames
+float motionTime = 0, previousMotionTime = 0; // path position after the last two ticks
+const float motionSpeed = 0.6f;                // of the whole path per second
+UniformBlock<CameraBlock> camera(CameraBinding);
+UniformBlock<LightBlock> light(LightBinding);
+UniformBlock<MaterialBlock> material(MaterialBinding);
+
+// crowd members stand on a square grid, front row centred on the origin
+glm::vec3 crowdOffset(size_t i) {
+	const size_t side = size_t(std::ceil(std::sqrt(double(instances.size()))));
+	return glm::vec3(4.0f * (float(i % side) - float(side - 1) / 2), 0, -4.0f * float(i / side));
+}
+
+void updateInstances(float time) {
+	static std::vector<float> times;
+	static std::vector<glm::vec3> offsets;
+	if (instances.empty()) return;
+	times.resize(instances.size());
+	offsets.resize(instances.size());
+	for (size_t i = 0; i < instances.size(); ++i) {
+		float t = time + float(i) / float(instances.size());
+		times[i] = t > 1.0f ? t - 1.0f : t;
+		offsets[i] = crowdOffset(i);
+	}
+	motion.getTransforms(times.data(), offsets.data(), instances.size(), &instances[0].model, &instances[0].normal,
+	                     sizeof(Instance), &workers);
+}
+
+// resizes the crowd and backs the camera off far enough to keep the grid in view
+void setCrowdSize(int n) {
+	crowdSize = std::clamp(n, 1, maxCrowdSize);
+	instances.resize(size_t(crowdSize));
+	const float side = std::ceil(std::sqrt(float(crowdSize)));
+	CameraBlock &cam = camera.edit();
+	cam.viewPos = glm::vec3(0, 0, 5 + 6 * (side - 1));
+	cam.view = glm::translate(glm::mat4(1), -cam.viewPos);
+	std::cout << crowdSize << " models\n";
+}
+
+void updateProjection() {
+	camera.edit().projection = glm::perspective(glm::radians(45.0f), float(W) / H, 1.0f, 2000.0f);
+}
 
 // Init
 void init() {
 	shader = std::make_unique<Shader>(vsSrc, fsSrc);
 	model = std::make_unique<Model>();
+	model->mesh.layout = VertexLayout::Quantized; // or Float
 	if (!model->load("teapot.obj")) std::cerr << "Failed to load model.\n";
 	glClearDepth(1.0f);
-	lastTime = std::chrono::steady_clock::now();
+
+	setCrowdSize(crowdSize);
+	updateProjection();
+	LightBlock &l = light.edit();
+	l.pos = glm::vec3(5, 5, 5);
+	l.ambient = glm::vec3(0.4f);
+	l.diffuse = glm::vec3(0.3f);
+	l.specular = glm::vec3(0.4f);
+	MaterialBlock &m = material.edit();
+	m.ambient = glm::vec3(0.11f, 0.06f, 0.11f);
+	m.diffuse = glm::vec3(0.43f, 0.47f, 0.54f);
+	m.specular = glm::vec3(0.33f, 0.33f, 0.52f);
+	m.emission = glm::vec3(0.1f, 0, 0.1f);
+	m.shininess = 10.0f;
 
 	motion.orientType = OrientationType::Quaternion; // or Euler
 	motion.interpType = InterpType::CatmullRom;      // or BSpline
+	motion.constantSpeed = true;                     // or false: the same time for every pair of keys
 
 	motion.addKey(glm::vec3(0, 0, 0), glm::quat(glm::vec3(0, 0, 0)));
 	motion.addKey(glm::vec3(2, 0, 0), glm::quat(glm::vec3(0, glm::radians(90.0f), 0)));
 	motion.addKey(glm::vec3(2, 2, 0), glm::quat(glm::vec3(glm::radians(90.0f), glm::radians(90.0f), 0)));
 	motion.addKey(glm::vec3(0, 2, 0), glm::quat(glm::vec3(glm::radians(180.0f), 0, 0)));
+	updateInstances(motionTime);
 }
 
-// animation happens here
+// animation happens here, one fixed step of tickSeconds per call
 void update() {
-	auto now = std::chrono::steady_clock::now();
-	static const int frameTime = 1000 / FPS;
-	if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTime).count() >= frameTime) {
-		// 	angle = (angle + 5) % 360;
-		// 	modelMat = glm::rotate(glm::mat4(1), glm::radians(float(angle)), glm::vec3(0, 1, 0));
-		motionTime += 0.01f; // speed
-		if (motionTime > 1.0f) motionTime = 0.0f;
-		modelMat = motion.getTransform(motionTime);
-		lastTime = now;
-	}
+	// 	angle = (angle + 5) % 360;
+	// 	instances[0].model = glm::rotate(glm::mat4(1), glm::radians(float(angle)), glm::vec3(0, 1, 0));
+	previousMotionTime = motionTime;
+	motionTime += motionSpeed * float(tickSeconds);
+	if (motionTime > 1.0f) motionTime -= 1.0f;
 }
 
-void render() {
+// alpha is how far the clock is past the last tick, in ticks; the crowd is drawn that far
+// between the last two simulated states
+void render(float alpha) {
+	float next = motionTime < previousMotionTime ? motionTime + 1.0f : motionTime; // wrapped in the last tick
+	float t = previousMotionTime + (next - previousMotionTime) * alpha;
+	updateInstances(t > 1.0f ? t - 1.0f : t);
+
 	glClearColor(0, 0, 0, 0);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glEnable(GL_DEPTH_TEST);
 	shader->use();
-	shader->set("lightPos", glm::vec3(5, 5, 5));
-	shader->set("lightAmbient", glm::vec3(0.4f));
-	shader->set("lightDiffuse", glm::vec3(0.3f));
-	shader->set("lightSpecular", glm::vec3(0.4f));
-	shader->set("materialAmbient", glm::vec3(0.11f, 0.06f, 0.11f));
-	shader->set("materialDiffuse", glm::vec3(0.43f, 0.47f, 0.54f));
-	shader->set("materialSpecular", glm::vec3(0.33f, 0.33f, 0.52f));
-	shader->set("materialEmission", glm::vec3(0.1f, 0, 0.1f));
-	shader->set("materialShininess", 10.0f);
-	shader->set("viewPos", glm::vec3(0, 0, 5));
-	glm::mat4 view = glm::translate(glm::mat4(1), glm::vec3(0, 0, -5));
-	glm::mat4 proj = glm::perspective(glm::radians(45.0f), float(W) / H, 1.0f, 2000.0f);
-	shader->set("model", modelMat);
-	shader->set("view", view);
-	shader->set("projection", proj);
-	shader->set("normalMatrix", glm::transpose(glm::inverse(glm::mat3(modelMat))));
+	// no-ops unless something changed since the last frame
+	camera.upload();
+	light.upload();
+	material.upload();
+	shader->set("posOffset", model->mesh.posOffset);
+	shader->set("posScale", model->mesh.posScale);
+	model->mesh.setInstances(instances);
 	model->draw();
 }
 
 // Input/resize
-void key(GLFWwindow *w, int k, int, int, int) {
+void key(GLFWwindow *w, int k, int, int action, int) {
 	if (k == GLFW_KEY_ESCAPE) glfwSetWindowShouldClose(w, 1);
+	if (action == GLFW_RELEASE) return;
+	if (k == GLFW_KEY_UP) setCrowdSize(crowdSize * 2);
+	if (k == GLFW_KEY_DOWN) setCrowdSize(crowdSize / 2);
 }
 void resize(GLFWwindow *, int w, int h) {
 	W = w;
 	H = h;
 	glViewport(0, 0, w, h);
+	updateProjection();
 }
 
 // Main
-int main() {
+// usage: oglproj1 [models], e.g. 4096 to draw a crowd of that many
+int main(int argc, char **argv) {
+	if (argc > 1) crowdSize = std::atoi(argv[1]);
 	if (!glfwInit()) return -1;
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -359,15 +716,28 @@ int main() {
 		return -1;
 	}
 	glfwMakeContextCurrent(win);
+	glfwSwapInterval(1); // vsync; the buffer swap waits for the display instead of tearing
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) return -1;
 	init();
 	glfwSetKeyCallback(win, key);
 	glfwSetFramebufferSizeCallback(win, resize);
+	// The simulation runs in fixed ticks, as many as the clock has advanced by, whatever the frame
+	// rate; frames are drawn at most FPS times a second, and the thread sleeps in between, waking
+	// early for input.
+	double last = glfwGetTime(), accumulator = 0;
 	while (!glfwWindowShouldClose(win)) {
-		update();
-		render();
+		const double frameStart = glfwGetTime();
+		accumulator += std::min(frameStart - last, maxFrameSeconds);
+		last = frameStart;
+		while (accumulator >= tickSeconds) {
+			update();
+			accumulator -= tickSeconds;
+		}
+		render(float(accumulator / tickSeconds));
 		glfwSwapBuffers(win);
-		glfwPollEvents();
+		const double idle = 1.0 / FPS - (glfwGetTime() - frameStart);
+		if (idle > 0) glfwWaitEventsTimeout(idle);
+		else glfwPollEvents();
 	}
 	glfwTerminate();
 	return 0;